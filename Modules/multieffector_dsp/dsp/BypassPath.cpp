@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    BypassPath.cpp
+    Implementation of the bypass path.
+
+  ==============================================================================
+*/
+
+template<typename SampleType>
+void BypassPath<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, int maxDelayInSamples)
+{
+    eqChain.prepare(spec);
+
+    for (auto& filter : allpasses)
+    {
+        filter.prepare(spec);
+        filter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    }
+
+    delay.prepare(spec);
+    delay.setMaximumDelayInSamples(maxDelayInSamples);
+}
+
+template<typename SampleType>
+void BypassPath<SampleType>::reset()
+{
+    eqChain.reset();
+    for (auto& filter : allpasses)
+        filter.reset();
+    delay.reset();
+}
+
+template<typename SampleType>
+void BypassPath<SampleType>::setCrossovers(const std::array<float, numCrossovers>& crossovers, CrossoverMode mode)
+{
+    // The linear-phase bands sum to a plain delay, which is already part of setDelay()
+    useAllpasses = mode == CrossoverMode::LinkwitzRiley;
+    if (! useAllpasses)
+        return;
+
+    for (size_t i = 0; i < allpasses.size(); ++i)
+        allpasses[i].setCutoffFrequency(crossovers[i]);
+}
+
+template<typename SampleType>
+void BypassPath<SampleType>::setDelay(int delayInSamples)
+{
+    jassert(delayInSamples <= delay.getMaximumDelayInSamples());
+    delay.setDelay((SampleType) delayInSamples);
+}
+
+template<typename SampleType>
+void BypassPath<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, const typename MultichannelEQ<SampleType>::InterleavedBlock& interleaved)
+{
+    interleaveChannels(block, interleaved);
+    eqChain.process(interleaved);
+    deinterleaveChannels(interleaved, block);
+
+    // Linkwitz-Riley bands sum to an allpass at every crossover
+    if (useAllpasses)
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* data = block.getChannelPointer(channel);
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+            {
+                auto sample = data[i];
+                for (auto& filter : allpasses)
+                    sample = filter.processSample((int) channel, sample);
+                data[i] = sample;
+            }
+        }
+
+        for (auto& filter : allpasses)
+            filter.snapToZero();
+    }
+
+    delay.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+}
+
+template struct BypassPath<float>;
+template struct BypassPath<double>;
\ No newline at end of file
@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    BypassPath.h
+    The host-rate path used while no band distorts.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Runs at the host rate instead of the oversampled path while every band is Inactive.
+// Then all the oversampled path does is apply the EQ, the allpasses the Linkwitz-Riley
+// bands sum to (or the linear-phase crossover's delay) and the oversampler's latency,
+// so this applies the same things. Its output lines up with the oversampled path's,
+// which lets processBlock crossfade between them.
+template<typename SampleType>
+struct BypassPath
+{
+    void prepare(const juce::dsp::ProcessSpec& spec, int maxDelayInSamples);
+    void reset();
+    void setCrossovers(const std::array<float, numCrossovers>& crossovers, CrossoverMode mode);
+    void setDelay(int delayInSamples);
+    void process(const juce::dsp::AudioBlock<SampleType>& block, const typename MultichannelEQ<SampleType>::InterleavedBlock& interleaved);
+    
+    MultichannelEQ<SampleType> eqChain; // gets coefficients designed for the host rate
+private:
+    std::array<juce::dsp::LinkwitzRileyFilter<SampleType>, numCrossovers> allpasses;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> delay;
+    bool useAllpasses = true;
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ControlBlocks.cpp
+    Implementation of the control-rate block splitter.
+
+  ==============================================================================
+*/
+
+void ControlBlocks::prepare(double sampleRate, int maxBlockSize, const ChainSettings& initialSettings)
+{
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        crossovers[i].reset(sampleRate, smoothingSeconds);
+        crossovers[i].setCurrentAndTargetValue(initialSettings.crossovers[i]);
+    }
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        auto& smoothers = bands[band];
+        const auto& settings = initialSettings.bands[band];
+
+        smoothers.drive.reset(sampleRate, smoothingSeconds);
+        smoothers.postGain.reset(sampleRate, smoothingSeconds);
+        smoothers.mix.reset(sampleRate, smoothingSeconds);
+
+        smoothers.drive.setCurrentAndTargetValue(settings.drive);
+        smoothers.postGain.setCurrentAndTargetValue(settings.postGain);
+        smoothers.mix.setCurrentAndTargetValue(settings.mix);
+    }
+
+    // One segment per control block, plus the partial ones at either end
+    segments.reserve((size_t) (maxBlockSize / minBlockSize + 2));
+
+    current = initialSettings;
+    samplesUntilUpdate = 0;
+}
+
+void ControlBlocks::update(const ChainSettings& snapshot)
+{
+    const auto blockSize = juce::jmax(minBlockSize, snapshot.controlBlockSize);
+    auto settings = snapshot;
+
+    // Ramps that restart at different times can cross, so keep the crossovers in order
+    float lowerCrossover = 0.0f;
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        crossovers[i].setTargetValue(snapshot.crossovers[i]);
+        settings.crossovers[i] = juce::jmax(crossovers[i].skip(blockSize), lowerCrossover);
+        lowerCrossover = settings.crossovers[i];
+    }
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        auto& smoothers = bands[band];
+        const auto& target = snapshot.bands[band];
+
+        // A band going Inactive stops processing at once, and one coming back starts
+        // with its new settings. Ramping either way would fade the wet signal against
+        // a dry one that jumps when the band switches.
+        const bool snap = getBandActivity(current.bands[band]) == BandActivity::Inactive
+                       || getBandActivity(target) == BandActivity::Inactive;
+
+        if (snap)
+        {
+            smoothers.drive.setCurrentAndTargetValue(target.drive);
+            smoothers.postGain.setCurrentAndTargetValue(target.postGain);
+            smoothers.mix.setCurrentAndTargetValue(target.mix);
+        }
+        else
+        {
+            smoothers.drive.setTargetValue(target.drive);
+            smoothers.postGain.setTargetValue(target.postGain);
+            smoothers.mix.setTargetValue(target.mix);
+        }
+
+        settings.bands[band].drive = smoothers.drive.skip(blockSize);
+        settings.bands[band].postGain = smoothers.postGain.skip(blockSize);
+        settings.bands[band].mix = smoothers.mix.skip(blockSize);
+    }
+
+    current = settings;
+    samplesUntilUpdate = blockSize;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    ControlBlocks.h
+    Cuts host blocks at fixed control-rate boundaries and smooths the
+    continuous settings from one control block to the next.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Parameters are read, and the crossovers and band distortions updated, once per
+// control block of ChainSettings::controlBlockSize samples rather than once per host
+// block. Control blocks are counted from prepare(), not from the start of each host
+// block, so a boundary lands on the same sample whatever buffer sizes the host uses:
+// one host block can hold several control blocks, or one control block can span
+// several host blocks.
+// The crossovers and each band's drive, post gain and mix ramp towards every new
+// snapshot over smoothingSeconds, one step per control block, so sweeping them sounds
+// the same at any host block size. The rest of a snapshot applies as it is.
+class ControlBlocks
+{
+public:
+    // The smallest control block, which bounds how many segments a host block can hold
+    static constexpr int minBlockSize = 8;
+    static constexpr double smoothingSeconds = 0.03;
+
+    // A stretch of a host block, in host samples, and the settings it runs with
+    struct Segment
+    {
+        int start = 0, length = 0;
+        ChainSettings settings;
+    };
+
+    // Not on the audio thread. The first control block starts at the next host block,
+    // with the smoothing already settled on initialSettings.
+    void prepare(double sampleRate, int maxBlockSize, const ChainSettings& initialSettings);
+
+    // Audio thread: cuts a host block at every control boundary in it, calling
+    // loadSettings() for a new snapshot at each one. The first segment carries on with
+    // the settings of the control block in progress, unless the host block starts on
+    // a boundary. There is always at least one segment, even for an empty block.
+    template<typename LoadSettings>
+    const std::vector<Segment>& split(int numSamples, LoadSettings&& loadSettings)
+    {
+        segments.clear();
+        auto start = 0;
+
+        do
+        {
+            if (samplesUntilUpdate == 0 && start < numSamples)
+                update(loadSettings());
+
+            const auto length = juce::jmin(numSamples - start, samplesUntilUpdate);
+            jassert(segments.size() < segments.capacity());
+            segments.push_back({ start, length, current });
+
+            start += length;
+            samplesUntilUpdate -= length;
+        }
+        while (start < numSamples);
+
+        return segments;
+    }
+private:
+    // Starts a control block: takes a new snapshot and moves the smoothed settings a
+    // whole control block towards it
+    void update(const ChainSettings& snapshot);
+
+    using LinearSmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+    using FrequencySmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+
+    struct BandSmoothers
+    {
+        LinearSmoother drive, postGain, mix;
+    };
+
+    std::array<FrequencySmoother, numCrossovers> crossovers;
+    std::array<BandSmoothers, numBands> bands;
+
+    ChainSettings current; // what the control block in progress runs with
+    std::vector<Segment> segments; // reserved in prepare, so split() never allocates
+    int samplesUntilUpdate = 0;
+};
@@ -0,0 +1,377 @@
+/*
+  ==============================================================================
+
+    Crossovers.cpp
+    Implementation of the crossovers.
+
+  ==============================================================================
+*/
+
+template<typename SampleType>
+void CrossoverFilters<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // The split filters use processSample(channel, input, low, high), which produces
+    // both outputs whatever the type, so only the allpasses need their type set
+    for (auto& filter : splits)
+        filter.prepare(spec);
+
+    for (auto& filter : allpasses)
+    {
+        filter.prepare(spec);
+        filter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    }
+}
+
+template<typename SampleType>
+void CrossoverFilters<SampleType>::reset()
+{
+    for (auto& filter : splits)
+        filter.reset();
+
+    for (auto& filter : allpasses)
+        filter.reset();
+}
+
+template<typename SampleType>
+void CrossoverFilters<SampleType>::update(const std::array<float, numCrossovers>& crossovers) {
+    for (size_t i = 0; i < splits.size(); ++i)
+        splits[i].setCutoffFrequency(crossovers[i]);
+
+    for (size_t i = 0; i < allpasses.size(); ++i)
+        allpasses[i].setCutoffFrequency(crossovers[i + 1]);
+}
+
+template<typename SampleType>
+std::array<float, numCrossovers> CrossoverFilters<SampleType>::getCutoffFrequencies() const
+{
+    std::array<float, numCrossovers> frequencies;
+    for (size_t i = 0; i < splits.size(); ++i)
+        frequencies[i] = (float) splits[i].getCutoffFrequency();
+    return frequencies;
+}
+
+template<typename SampleType>
+void CrossoverFilters<SampleType>::split(const juce::dsp::AudioBlock<SampleType>& input, const BandBlocks& bands)
+{
+    const auto numSamples = input.getNumSamples();
+    std::array<SampleType*, numBands> bandData;
+
+    for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+    {
+        const auto* inputData = input.getChannelPointer(channel);
+        for (size_t band = 0; band < bandData.size(); ++band)
+            bandData[band] = bands[band].getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            // Peel one band off the bottom of what's left at each crossover
+            SampleType upper = inputData[i];
+            for (size_t crossover = 0; crossover < splits.size(); ++crossover)
+                splits[crossover].processSample((int) channel, upper, bandData[crossover][i], upper);
+
+            bandData[numBands - 1][i] = upper;
+        }
+    }
+
+    for (auto& filter : splits)
+        filter.snapToZero();
+}
+
+template<typename SampleType>
+void CrossoverFilters<SampleType>::recombine(const BandBlocks& bands, const juce::dsp::AudioBlock<SampleType>& output)
+{
+    const auto numSamples = output.getNumSamples();
+    std::array<const SampleType*, numBands> bandData;
+
+    for (size_t channel = 0; channel < output.getNumChannels(); ++channel)
+    {
+        auto* outputData = output.getChannelPointer(channel);
+        for (size_t band = 0; band < bandData.size(); ++band)
+            bandData[band] = bands[band].getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            // Everything below band k goes through the allpass at crossover k before
+            // band k is added, then the top band goes straight on
+            SampleType sum = bandData[0][i];
+            for (size_t band = 1; band < numBands - 1; ++band)
+                sum = allpasses[band - 1].processSample((int) channel, sum) + bandData[band][i];
+
+            outputData[i] = sum + bandData[numBands - 1][i];
+        }
+    }
+
+    for (auto& filter : allpasses)
+        filter.snapToZero();
+}
+
+template struct CrossoverFilters<float>;
+template struct CrossoverFilters<double>;
+
+std::unique_ptr<LinearPhaseCrossover::KernelSet> LinearPhaseCrossover::design(const Crossovers& crossovers, double sampleRate, int numPartitions)
+{
+    auto set = std::make_unique<KernelSet>();
+    set->crossovers = crossovers;
+    set->sampleRate = sampleRate;
+    set->numPartitions = numPartitions;
+    set->spectra.resize((size_t) numBands * (size_t) numPartitions * spectrumSize);
+    
+    // Blackman windowed sinc lowpasses centred on length / 2. Tap 0 stays at zero so
+    // every kernel is symmetric and the delay is a whole number of samples.
+    const auto length = numPartitions * partitionSize;
+    const auto centre = length / 2;
+    const auto pi = juce::MathConstants<double>::pi;
+    
+    std::array<std::vector<double>, numCrossovers> lowpasses;
+    for (size_t crossover = 0; crossover < lowpasses.size(); ++crossover)
+    {
+        auto& taps = lowpasses[crossover];
+        taps.assign((size_t) length, 0.0);
+        
+        const auto cutoff = juce::jlimit(1.0, 0.49 * sampleRate, (double) crossovers[crossover]) / sampleRate;
+        double sum = 0.0;
+        
+        for (int n = 1; n < length; ++n)
+        {
+            const auto offset = double(n - centre);
+            const auto sinc = n == centre ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * offset) / (pi * offset);
+            const auto phase = double(n - 1) / double(length - 2);
+            const auto window = 0.42 - 0.5 * std::cos(2.0 * pi * phase) + 0.08 * std::cos(4.0 * pi * phase);
+            taps[(size_t) n] = sinc * window;
+            sum += taps[(size_t) n];
+        }
+        
+        // Unity gain at DC, so the band below this crossover passes low frequencies exactly
+        for (auto& tap : taps)
+            tap /= sum;
+    }
+    
+    // Each band is the difference between the lowpasses on either side of it, with a
+    // pure delay above the top crossover, so the bands add up to exactly that delay
+    juce::dsp::FFT designFFT(partitionOrder + 1);
+    std::vector<float> kernel((size_t) length), buffer((size_t) fftSize * 2);
+    auto* spectrum = set->spectra.data();
+    
+    for (size_t band = 0; band < (size_t) numBands; ++band)
+    {
+        for (int n = 0; n < length; ++n)
+        {
+            const auto below = band > 0 ? lowpasses[band - 1][(size_t) n] : 0.0;
+            const auto above = band < (size_t) numCrossovers ? lowpasses[band][(size_t) n] : (n == centre ? 1.0 : 0.0);
+            kernel[(size_t) n] = static_cast<float>(above - below);
+        }
+        
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            std::copy_n(kernel.begin() + partition * partitionSize, partitionSize, buffer.begin());
+            designFFT.performRealOnlyForwardTransform(buffer.data(), true);
+            std::copy_n(buffer.begin(), spectrumSize, spectrum);
+            spectrum += spectrumSize;
+        }
+    }
+    
+    return set;
+}
+
+void LinearPhaseCrossover::prepare(const juce::dsp::ProcessSpec& spec, const Crossovers& crossovers, double maxSampleRate)
+{
+    const auto maxPartitions = getKernelLength(juce::jmax(maxSampleRate, spec.sampleRate)) / partitionSize;
+    
+    channels.resize(spec.numChannels);
+    for (auto& state : channels)
+    {
+        state.input.resize(partitionSize * 2);
+        state.history.resize((size_t) maxPartitions * spectrumSize);
+        for (auto& output : state.output)
+            output.resize(partitionSize);
+    }
+    
+    fftBuffer.resize(fftSize * 2);
+    fadeBuffer.resize(partitionSize);
+    
+    setSampleRate(spec.sampleRate);
+    
+    const juce::ScopedLock lock(buildLock);
+    
+    // The audio thread is stopped and the lock keeps the background thread out,
+    // so everything queued so far can be thrown away from here
+    Request staleRequest;
+    while (requests.pull(staleRequest)) {}
+    kernels.clear();
+    
+    kernels.reset(design(crossovers, sampleRate, numPartitions));
+    lastRequest = { crossovers, sampleRate, numPartitions };
+}
+
+void LinearPhaseCrossover::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    kernelLength = getKernelLength(sampleRate);
+    numPartitions = kernelLength / partitionSize;
+    
+    jassert(channels.empty() || (size_t) numPartitions * spectrumSize <= channels.front().history.size());
+    reset();
+}
+
+void LinearPhaseCrossover::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.input.begin(), state.input.end(), 0.0f);
+        std::fill(state.history.begin(), state.history.end(), 0.0f);
+        for (auto& output : state.output)
+            std::fill(output.begin(), output.end(), 0.0f);
+    }
+    
+    historyIndex = 0;
+    fillPosition = 0;
+}
+
+void LinearPhaseCrossover::requestDesign(const Crossovers& crossovers)
+{
+    if (lastRequest.crossovers == crossovers && lastRequest.sampleRate == sampleRate)
+        return;
+    
+    Request request { crossovers, sampleRate, numPartitions };
+    
+    // If the queue is full, try again next block
+    if (requests.push(request))
+        lastRequest = request;
+}
+
+int LinearPhaseCrossover::useTimeSlice()
+{
+    const juce::ScopedLock lock(buildLock);
+    kernels.collectGarbage();
+    
+    // Only the most recent request matters
+    Request request;
+    bool hasRequest = false;
+    while (requests.pull(request))
+        hasRequest = true;
+    
+    if (hasRequest && request.sampleRate > 0.0)
+        kernels.publish(design(request.crossovers, request.sampleRate, request.numPartitions));
+    
+    return pollIntervalMs;
+}
+
+template<typename SampleType>
+void LinearPhaseCrossover::split(const juce::dsp::AudioBlock<SampleType>& input, const BandBlocks<SampleType>& bands)
+{
+    const auto numChannels = juce::jmin(input.getNumChannels(), channels.size());
+    const auto numSamples = input.getNumSamples();
+    
+    // Each input sample comes out of the bands exactly one partition later, once the
+    // partition it went into has been convolved
+    for (size_t done = 0; done < numSamples;)
+    {
+        const auto count = juce::jmin(numSamples - done, size_t(partitionSize - fillPosition));
+        
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto& state = channels[channel];
+            copyConverted(input.getChannelPointer(channel) + done, count, state.input.data() + partitionSize + fillPosition);
+            
+            for (size_t band = 0; band < bands.size(); ++band)
+                copyConverted(state.output[band].data() + fillPosition, count, bands[band].getChannelPointer(channel) + done);
+        }
+        
+        done += count;
+        fillPosition += (int) count;
+        
+        if (fillPosition == partitionSize)
+        {
+            processPartition(numChannels);
+            fillPosition = 0;
+        }
+    }
+}
+
+template<typename SampleType>
+void LinearPhaseCrossover::recombine(const BandBlocks<SampleType>& bands, const juce::dsp::AudioBlock<SampleType>& output)
+{
+    // The band kernels add up to a delay, so a plain sum is flat
+    output.copyFrom(bands[0]);
+    for (size_t band = 1; band < bands.size(); ++band)
+        output.add(bands[band]);
+}
+
+template void LinearPhaseCrossover::split<float>(const juce::dsp::AudioBlock<float>&, const BandBlocks<float>&);
+template void LinearPhaseCrossover::split<double>(const juce::dsp::AudioBlock<double>&, const BandBlocks<double>&);
+template void LinearPhaseCrossover::recombine<float>(const BandBlocks<float>&, const juce::dsp::AudioBlock<float>&);
+template void LinearPhaseCrossover::recombine<double>(const BandBlocks<double>&, const juce::dsp::AudioBlock<double>&);
+
+void LinearPhaseCrossover::processPartition(size_t numChannels)
+{
+    // Pick up a new kernel set at the partition boundary. One designed for another
+    // sample rate (finished just as the rate changed) is retired without being used,
+    // and the design for the new rate follows it. There's nothing to fade from when the
+    // kernels before it were for the old rate, as the history was cleared with the change.
+    const KernelSet* fadeFrom = nullptr;
+    if (kernels.acquire([this](const KernelSet& set) { return set.sampleRate == sampleRate; }) != nullptr)
+    {
+        auto* previous = kernels.getPrevious();
+        if (previous != nullptr && previous->sampleRate == sampleRate)
+            fadeFrom = previous;
+    }
+    
+    const auto* current = kernels.getCurrent();
+    if (current == nullptr)
+        return;
+    
+    historyIndex = (historyIndex + 1) % numPartitions;
+    const auto fadeStep = 1.0f / float(partitionSize);
+    
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channels[channel];
+        
+        // One forward transform of the last two partitions feeds every band
+        std::copy(state.input.begin(), state.input.end(), fftBuffer.begin());
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy_n(fftBuffer.begin(), spectrumSize, state.history.begin() + historyIndex * spectrumSize);
+        
+        for (size_t band = 0; band < (size_t) numBands; ++band)
+        {
+            auto* output = state.output[band].data();
+            convolve(state, *current, band, output);
+            
+            if (fadeFrom != nullptr)
+            {
+                convolve(state, *fadeFrom, band, fadeBuffer.data());
+                for (int i = 0; i < partitionSize; ++i)
+                    output[i] = fadeBuffer[(size_t) i] + (output[i] - fadeBuffer[(size_t) i]) * fadeStep * float(i + 1);
+            }
+        }
+        
+        std::copy_n(state.input.begin() + partitionSize, partitionSize, state.input.begin());
+    }
+}
+
+void LinearPhaseCrossover::convolve(const ChannelState& state, const KernelSet& kernelSet, size_t band, float* destination)
+{
+    auto* accumulator = fftBuffer.data();
+    std::fill_n(accumulator, spectrumSize, 0.0f);
+    
+    // Partition p of the kernel meets the input from p partitions ago. A kernel set
+    // designed for another rate may be shorter or longer, so only use what both have.
+    const auto partitions = juce::jmin(kernelSet.numPartitions, numPartitions);
+    for (int partition = 0; partition < partitions; ++partition)
+    {
+        const auto slot = (historyIndex - partition + numPartitions) % numPartitions;
+        const auto* x = state.history.data() + slot * spectrumSize;
+        const auto* h = kernelSet.getSpectrum(band, partition);
+        
+        for (int bin = 0; bin < spectrumSize; bin += 2)
+        {
+            accumulator[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+            accumulator[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+        }
+    }
+    
+    // Overlap-save: the second half of the circular convolution is the valid part
+    fft.performRealOnlyInverseTransform(accumulator);
+    std::copy_n(accumulator + partitionSize, partitionSize, destination);
+}
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    Crossovers.h
+    The band splitters: the Linkwitz-Riley crossover and its linear-phase
+    alternative.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// A numBands Linkwitz-Riley split. Each split filter takes the signal above the
+// previous crossover and divides it again, all in the same pass over the input, so
+// the cost grows by one filter per band. Band k skips the splits above it, so on the
+// way back the running sum goes through an allpass at each of those crossovers
+// instead, which keeps every band in phase and makes them sum flat.
+template<typename SampleType>
+struct CrossoverFilters {
+    using BandBlocks = std::array<juce::dsp::AudioBlock<SampleType>, numBands>;
+
+    std::array<juce::dsp::LinkwitzRileyFilter<SampleType>, numCrossovers> splits;
+    std::array<juce::dsp::LinkwitzRileyFilter<SampleType>, numCrossovers - 1> allpasses; // at crossovers 1..N-2
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+    void update(const std::array<float, numCrossovers>& crossovers);
+    std::array<float, numCrossovers> getCutoffFrequencies() const;
+
+    void split(const juce::dsp::AudioBlock<SampleType>& input, const BandBlocks& bands);
+
+    // Sums the bands into output, which may be the block that was split
+    void recombine(const BandBlocks& bands, const juce::dsp::AudioBlock<SampleType>& output);
+};
+
+// A linear-phase alternative to CrossoverFilters. Every band is an FIR filter, and the
+// band filters add up to a pure delay, so the bands sum back flat without any phase
+// shift. The filters run as uniformly partitioned FFT convolution: once every
+// partitionSize samples each channel gets one forward FFT, which goes into a history
+// of input spectra shared by all the bands, and each band multiplies that history by
+// its kernel spectra and does one inverse FFT.
+// The price is getLatencyInSamples() of delay, at the rate it was prepared with.
+// Kernels are designed on the BackgroundDesignThread whenever a crossover moves. A new
+// set is picked up at a partition boundary and crossfaded in over one partition.
+// juce::dsp::FFT only works in float, so the convolution does too whatever the sample
+// type of the blocks; samples are converted as they're copied in and out of partitions.
+class LinearPhaseCrossover : public juce::TimeSliceClient
+{
+public:
+    template<typename SampleType>
+    using BandBlocks = typename CrossoverFilters<SampleType>::BandBlocks;
+    using Crossovers = std::array<float, numCrossovers>;
+    
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder;
+    static constexpr int fftSize = partitionSize * 2;
+    static constexpr int spectrumSize = fftSize + 2; // interleaved bins 0..fftSize/2
+    
+    struct KernelSet
+    {
+        Crossovers crossovers{};
+        double sampleRate = 0.0;
+        int numPartitions = 0;
+        std::vector<float> spectra; // for each band, the spectrum of each partition
+        
+        const float* getSpectrum(size_t band, int partition) const
+        {
+            return spectra.data() + (band * (size_t) numPartitions + (size_t) partition) * spectrumSize;
+        }
+    };
+    
+    static std::unique_ptr<KernelSet> design(const Crossovers& crossovers, double sampleRate, int numPartitions);
+    
+    // Sizes everything for rates up to maxSampleRate, and designs the first kernels
+    // for the spec's rate straight away, dropping any that were queued or being
+    // designed before
+    void prepare(const juce::dsp::ProcessSpec& spec, const Crossovers& crossovers, double maxSampleRate);
+    void reset();
+    
+    int getLatencyInSamples() const { return partitionSize + kernelLength / 2; }
+    
+    // Audio thread: switches to another rate, up to the prepared maximum. Kernels for it
+    // are asked for on the next requestDesign(), and hasCurrentKernels() is false until
+    // they have arrived.
+    void setSampleRate(double newSampleRate);
+    bool hasCurrentKernels() const
+    {
+        auto* current = kernels.getCurrent();
+        return current != nullptr && current->sampleRate == sampleRate;
+    }
+    
+    // Audio thread
+    void requestDesign(const Crossovers& crossovers);
+    template<typename SampleType>
+    void split(const juce::dsp::AudioBlock<SampleType>& input, const BandBlocks<SampleType>& bands);
+    
+    // Sums the bands into output, which may be the block that was split
+    template<typename SampleType>
+    void recombine(const BandBlocks<SampleType>& bands, const juce::dsp::AudioBlock<SampleType>& output);
+    
+    int useTimeSlice() override;
+private:
+    struct Request
+    {
+        Crossovers crossovers{};
+        double sampleRate = 0.0;
+        int numPartitions = 0;
+    };
+    
+    struct ChannelState
+    {
+        std::vector<float> input;   // the previous partition followed by the one being filled
+        std::vector<float> history; // spectra of the last numPartitions input partitions
+        std::array<std::vector<float>, numBands> output; // the partition being played out
+    };
+    
+    static int getKernelLength(double rate)
+    {
+        return juce::jmax(juce::nextPowerOfTwo((int) std::ceil(rate * kernelSeconds)), partitionSize * 2);
+    }
+    
+    // Copies between the blocks and the float partitions, converting when they differ
+    template<typename Source, typename Destination>
+    static void copyConverted(const Source* source, size_t count, Destination* destination)
+    {
+        for (size_t i = 0; i < count; ++i)
+            destination[i] = static_cast<Destination>(source[i]);
+    }
+    
+    void processPartition(size_t numChannels);
+    void convolve(const ChannelState& state, const KernelSet& kernelSet, size_t band, float* destination);
+    
+    // Roughly how long the kernels are. The transition around each crossover is about
+    // 5.5 / kernelSeconds Hz wide, so the lowest crossovers get the gentlest slopes.
+    static constexpr double kernelSeconds = 0.04;
+    static constexpr int pollIntervalMs = 10;
+    
+    juce::dsp::FFT fft { partitionOrder + 1 };
+    std::vector<ChannelState> channels;
+    std::vector<float> fftBuffer, fadeBuffer;
+    double sampleRate = 0.0;
+    int kernelLength = 0, numPartitions = 0;
+    int historyIndex = 0, fillPosition = 0;
+    
+    // Held by prepare and while kernels are designed and published, so nothing
+    // designed for the old rate can turn up after prepare returns
+    juce::CriticalSection buildLock;
+    Fifo<Request> requests;
+    RealtimeHandoff<KernelSet> kernels;
+    Request lastRequest; // only touched by the audio thread (or prepare)
+};
@@ -0,0 +1,24 @@
+/*
+  ==============================================================================
+
+    Distortion.cpp
+    Implementation of the shaper tables.
+
+  ==============================================================================
+*/
+
+const ShaperTables& ShaperTables::getInstance()
+{
+    static const ShaperTables tables;
+    return tables;
+}
+
+ShaperTables::ShaperTables()
+{
+    const auto pi = juce::MathConstants<double>::pi;
+    const auto lastPoint = static_cast<double>(ShaperTable::size - 1);
+
+    tanh.fill([](double x) { return std::tanh(x); }, -tanhRange, 2.0 * tanhRange / lastPoint);
+    arcTan.fill([pi](double x) { return 2.0 / pi * std::atan(x); }, -arcTanRange, 2.0 * arcTanRange / lastPoint);
+    sine.fill([](double x) { return std::sin(x); }, 0.0, 2.0 * pi / ShaperTable::size);
+}
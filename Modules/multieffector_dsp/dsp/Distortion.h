@@ -0,0 +1,526 @@
+/*
+  ==============================================================================
+
+    Distortion.h
+    The waveshaper curves and the per-band Distortion processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Number of points in each waveshaper lookup table. Must be a power of two.
+#ifndef MULTIEFFECTOR_SHAPER_TABLE_SIZE
+ #define MULTIEFFECTOR_SHAPER_TABLE_SIZE 4096
+#endif
+
+// One transfer curve sampled at evenly spaced inputs. There is an extra point before
+// the first and two after the last, so cubic interpolation never needs a bounds check.
+struct ShaperTable
+{
+    static constexpr int size = MULTIEFFECTOR_SHAPER_TABLE_SIZE;
+    static_assert(size >= 16 && (size & (size - 1)) == 0, "The shaper table size must be a power of two");
+
+    template<typename Function>
+    void fill(Function curve, double firstInput, double step)
+    {
+        inputOffset = static_cast<float>(-firstInput / step);
+        inputScale = static_cast<float>(1.0 / step);
+
+        for (int i = 0; i < size + 3; ++i)
+            values[i] = static_cast<float>(curve(firstInput + (i - 1) * step));
+    }
+
+    // For curves that flatten out: inputs outside the table return the end points
+    template<bool Cubic, typename FloatType>
+    FloatType lookupClamped(FloatType x) const noexcept
+    {
+        auto position = x * FloatType(inputScale) + FloatType(inputOffset);
+        position = std::min(std::max(position, FloatType(0)), FloatType(size - 1));
+
+        const auto index = std::min(static_cast<int>(position), size - 2);
+        return interpolate<Cubic>(index, position - static_cast<FloatType>(index));
+    }
+
+    // For a table holding exactly one 2pi period. The input is wrapped with a two-part
+    // subtraction of 2pi so the fraction stays accurate for large arguments, and is
+    // clamped to +-1e5 to keep the period count in range.
+    template<bool Cubic, typename FloatType>
+    FloatType lookupPeriodic(FloatType x) const noexcept
+    {
+        x = std::copysign(std::min(std::abs(x), FloatType(1.0e5)), x);
+
+        const auto periods = static_cast<FloatType>(static_cast<int>(x * FloatType(0.159154943091895336)));
+        x = x - periods * FloatType(6.28125);
+        x = x - periods * FloatType(1.93530717958647692e-3);
+
+        // x is now within (-2pi, 2pi), so position is positive and truncating floors it
+        const auto position = x * FloatType(inputScale) + FloatType(size);
+        const auto index = static_cast<int>(position);
+        return interpolate<Cubic>(index & (size - 1), position - static_cast<FloatType>(index));
+    }
+
+    float inputOffset = 0, inputScale = 1;
+    alignas(64) float values[size + 3] = {};
+
+private:
+    template<bool Cubic, typename FloatType>
+    FloatType interpolate(int index, FloatType fraction) const noexcept
+    {
+        const auto* y = values + index;
+
+        if constexpr (Cubic)
+        {
+            // Catmull-Rom through y[0]..y[3], between y[1] and y[2]
+            const auto y0 = FloatType(y[0]), y1 = FloatType(y[1]), y2 = FloatType(y[2]), y3 = FloatType(y[3]);
+            const auto c1 = FloatType(0.5) * (y2 - y0);
+            const auto c2 = y0 - FloatType(2.5) * y1 + FloatType(2) * y2 - FloatType(0.5) * y3;
+            const auto c3 = FloatType(0.5) * (y3 - y0) + FloatType(1.5) * (y1 - y2);
+            return ((c3 * fraction + c2) * fraction + c1) * fraction + y1;
+        }
+        else
+        {
+            return FloatType(y[1]) + fraction * (FloatType(y[2]) - FloatType(y[1]));
+        }
+    }
+};
+
+// The tables for the curves that need a transcendental function. They are built once
+// per process, the first time getInstance() is called (Distortion::prepare makes sure
+// that isn't on the audio thread), and are only read from after that, so every band
+// of every plugin instance shares them. HardClipping and BitCrusher are cheaper to
+// compute than to look up and don't have tables.
+struct ShaperTables
+{
+    static const ShaperTables& getInstance();
+
+    // tanh has reached +-1 in single precision by +-8. The arctan curve keeps rising,
+    // so its table spans +-64 (drive 50 on a signal peaking above 0 dBFS) and holds
+    // its end value beyond that, 0.990 against a limit of 1.
+    static constexpr double tanhRange = 8.0;
+    static constexpr double arcTanRange = 64.0;
+
+    ShaperTable tanh, arcTan, sine;
+
+private:
+    ShaperTables();
+};
+
+// The transfer curve for each DistortionType. Every curve is its own specialisation,
+// so Distortion::process picks one per block and the per-sample loop can be inlined
+// instead of calling through a function pointer.
+// The curves that call a transcendental function have an Exact and a Fast version,
+// and use the primary template below for the table qualities; the others are
+// already cheap and ignore the quality. A curve that also takes a FastMath::Vector
+// gets processed a vector at a time.
+template<DistortionType Type, ShaperQuality Quality, typename FloatType>
+struct Waveshaper
+{
+    static_assert(Quality == ShaperQuality::TableLinear || Quality == ShaperQuality::TableCubic,
+                  "Only the table qualities use the primary template");
+
+    static constexpr bool cubic = Quality == ShaperQuality::TableCubic;
+
+    static const ShaperTable& getTable()
+    {
+        static_assert(Type == DistortionType::SoftClipping || Type == DistortionType::ArcTan || Type == DistortionType::SineFolding,
+                      "This curve has no table");
+
+        const auto& tables = ShaperTables::getInstance();
+
+        if constexpr (Type == DistortionType::SoftClipping)
+            return tables.tanh;
+        else if constexpr (Type == DistortionType::ArcTan)
+            return tables.arcTan;
+        else
+            return tables.sine;
+    }
+
+    FloatType operator()(FloatType x) const noexcept
+    {
+        if constexpr (Type == DistortionType::SineFolding)
+            return table.lookupPeriodic<cubic>(x);
+        else
+            return table.lookupClamped<cubic>(x);
+    }
+
+    // Looked up once per block, when the shaper is created
+    const ShaperTable& table = getTable();
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::SoftClipping, ShaperQuality::Exact, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept { return std::tanh(x); }
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::SoftClipping, ShaperQuality::Fast, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept { return FastMath::tanh(x); }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+    FastMath::Vector<FloatType> operator()(FastMath::Vector<FloatType> x) const noexcept { return FastMath::tanh(x); }
+#endif
+};
+
+template<ShaperQuality Quality, typename FloatType>
+struct Waveshaper<DistortionType::HardClipping, Quality, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept { return juce::jlimit(FloatType(-0.1), FloatType(0.1), x); }
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::ArcTan, ShaperQuality::Exact, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept
+    {
+        return static_cast<FloatType>(2.0 / juce::MathConstants<double>::pi * std::atan(x));
+    }
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::ArcTan, ShaperQuality::Fast, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept
+    {
+        return static_cast<FloatType>(2.0 / juce::MathConstants<double>::pi) * FastMath::atan(x);
+    }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+    FastMath::Vector<FloatType> operator()(FastMath::Vector<FloatType> x) const noexcept
+    {
+        return static_cast<FloatType>(2.0 / juce::MathConstants<double>::pi) * FastMath::atan(x);
+    }
+#endif
+};
+
+template<ShaperQuality Quality, typename FloatType>
+struct Waveshaper<DistortionType::BitCrusher, Quality, FloatType>
+{
+    FloatType quantizationLevels, quantizationStep;
+    
+    FloatType operator()(FloatType x) const noexcept
+    {
+        return FastMath::roundHalfAwayFromZero(x * quantizationLevels) * quantizationStep;
+    }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+    FastMath::Vector<FloatType> operator()(FastMath::Vector<FloatType> x) const noexcept
+    {
+        return FastMath::roundHalfAwayFromZero(x * quantizationLevels) * quantizationStep;
+    }
+#endif
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::SineFolding, ShaperQuality::Exact, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept { return std::sin(x); }
+};
+
+template<typename FloatType>
+struct Waveshaper<DistortionType::SineFolding, ShaperQuality::Fast, FloatType>
+{
+    FloatType operator()(FloatType x) const noexcept { return FastMath::sin(x); }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+    FastMath::Vector<FloatType> operator()(FastMath::Vector<FloatType> x) const noexcept { return FastMath::sin(x); }
+#endif
+};
+
+// A template class for distortion effects
+template <typename FloatType>
+class Distortion
+{
+public:
+    // The compensation gain is recalculated every controlChunkSize samples and ramped
+    // linearly in between. Chunks carry on from one process() call to the next, so the
+    // gain follows the same steps however the caller splits the signal into blocks.
+    static constexpr size_t controlChunkSize = 32;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        ShaperTables::getInstance();
+        sampleRate = spec.sampleRate;
+        updateBallistics();
+        reset();
+    }
+
+    void reset()
+    {
+        inputEnergy = 0;
+        outputEnergy = 0;
+        currentGain = postGain;
+        chunkPosition = 0;
+        std::fill(std::begin(inputSums), std::end(inputSums), FloatType(0));
+        std::fill(std::begin(outputSums), std::end(outputSums), FloatType(0));
+    }
+
+    void setPostGain(FloatType gainDecibels)
+    {
+        postGain = juce::Decibels::decibelsToGain(gainDecibels);
+    }
+
+    // Proportion of the shaped signal in the output, from 0 (dry) to 1 (wet)
+    void setMix(FloatType newMix)
+    {
+        mix = newMix;
+    }
+
+    // How quickly the level compensation follows a rise or fall in signal energy
+    void setCompensationTimes(float newAttackMs, float newReleaseMs)
+    {
+        if (newAttackMs == attackMs && newReleaseMs == releaseMs)
+            return;
+
+        attackMs = newAttackMs;
+        releaseMs = newReleaseMs;
+        updateBallistics();
+    }
+
+    void setType(DistortionType newType)
+    {
+        type = newType;
+    }
+
+    void setQuality(ShaperQuality newQuality)
+    {
+        quality = newQuality;
+    }
+
+    // Called every block, but the levels and step only change with the drive
+    void reduceBitDepth(float newBitDepth)
+    {
+        if (newBitDepth == bitDepth)
+            return;
+
+        bitDepth = newBitDepth;
+        quantizationLevels = static_cast<FloatType>(std::exp2(bitDepth));
+        quantizationStep = FloatType(1) / quantizationLevels;
+    }
+
+    void setDrive(float driveLinear)
+    {
+        drive = driveLinear;
+    }
+
+    void process(const juce::dsp::ProcessContextReplacing<FloatType>& context, bool enableCompensation)
+    {
+        compensationEnabled = enableCompensation;
+
+        // Process drive and waveshaper, picking the curve once for the whole block
+        switch (quality)
+        {
+            case ShaperQuality::Exact:
+                applyWaveshaper<ShaperQuality::Exact>(context.getOutputBlock());
+                break;
+            case ShaperQuality::TableLinear:
+                applyWaveshaper<ShaperQuality::TableLinear>(context.getOutputBlock());
+                break;
+            case ShaperQuality::TableCubic:
+                applyWaveshaper<ShaperQuality::TableCubic>(context.getOutputBlock());
+                break;
+            case ShaperQuality::Fast:
+            default:
+                applyWaveshaper<ShaperQuality::Fast>(context.getOutputBlock());
+                break;
+        }
+    }
+
+private:
+    template<ShaperQuality Quality>
+    void applyWaveshaper(const juce::dsp::AudioBlock<FloatType>& block)
+    {
+        switch (type)
+        {
+            case DistortionType::HardClipping:
+                applyWaveshaper(block, Waveshaper<DistortionType::HardClipping, Quality, FloatType>{});
+                break;
+            case DistortionType::ArcTan:
+                applyWaveshaper(block, Waveshaper<DistortionType::ArcTan, Quality, FloatType>{});
+                break;
+            case DistortionType::BitCrusher:
+                applyWaveshaper(block, Waveshaper<DistortionType::BitCrusher, Quality, FloatType>{ quantizationLevels, quantizationStep });
+                break;
+            case DistortionType::SineFolding:
+                applyWaveshaper(block, Waveshaper<DistortionType::SineFolding, Quality, FloatType>{});
+                break;
+            case DistortionType::SoftClipping:
+            default:
+                applyWaveshaper(block, Waveshaper<DistortionType::SoftClipping, Quality, FloatType>{});
+                break;
+        }
+    }
+
+    // Drive, waveshaper, compensation, post gain and dry/wet mix in a single pass over the block,
+    // measuring the input and output energy on the way. Channels share one gain, and
+    // the sums are split over energyLanes accumulators, so whole groups of energyLanes
+    // samples can go through the shaper a FastMath::Vector at a time without
+    // reordering a single running sum. Each sample goes to the lane of its position in
+    // the chunk, so a chunk split over two calls adds up the same as a whole one, and
+    // the vector and scalar loops add up the same as each other.
+    template<typename ShaperType>
+    void applyWaveshaper(const juce::dsp::AudioBlock<FloatType>& block, ShaperType shaper)
+    {
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = block.getNumSamples();
+        const auto driveGain = drive;
+        const auto wetGain = mix;
+        const auto dryGain = FloatType(1) - mix;
+
+        for (size_t start = 0; start < numSamples;)
+        {
+            if (chunkPosition == 0)
+            {
+                chunkStartGain = currentGain;
+                gainStep = (getTargetGain() - chunkStartGain) / static_cast<FloatType>(controlChunkSize);
+            }
+
+            const auto chunkLength = std::min(controlChunkSize - chunkPosition, numSamples - start);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* channelData = block.getChannelPointer(channel) + start;
+
+                auto shapeSample = [&](size_t i, size_t lane)
+                {
+                    const auto input = channelData[i];
+                    const auto output = shaper(driveGain * input);
+                    inputSums[lane] += input * input;
+                    outputSums[lane] += output * output;
+                    channelData[i] = dryGain * input + wetGain * output * (chunkStartGain + gainStep * static_cast<FloatType>(chunkPosition + i + 1));
+                };
+
+                size_t i = 0;
+
+                for (; i < chunkLength && (chunkPosition + i) % energyLanes != 0; ++i)
+                    shapeSample(i, (chunkPosition + i) % energyLanes);
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+                if constexpr (std::is_invocable_r_v<Vector, const ShaperType&, Vector>)
+                {
+                    constexpr auto vectorsPerGroup = energyLanes / vectorLanes;
+                    const auto laneIndices = FastMath::laneIndices<FloatType>();
+                    Vector inputVectors[vectorsPerGroup], outputVectors[vectorsPerGroup];
+
+                    for (size_t v = 0; v < vectorsPerGroup; ++v)
+                    {
+                        inputVectors[v] = FastMath::load(inputSums + v * vectorLanes);
+                        outputVectors[v] = FastMath::load(outputSums + v * vectorLanes);
+                    }
+
+                    for (; i + energyLanes <= chunkLength; i += energyLanes)
+                    {
+                        for (size_t v = 0; v < vectorsPerGroup; ++v)
+                        {
+                            const auto offset = i + v * vectorLanes;
+                            const auto input = FastMath::load(channelData + offset);
+                            const auto output = shaper(driveGain * input);
+                            inputVectors[v] += input * input;
+                            outputVectors[v] += output * output;
+
+                            const auto gain = chunkStartGain + gainStep * (static_cast<FloatType>(chunkPosition + offset + 1) + laneIndices);
+                            FastMath::store(channelData + offset, dryGain * input + wetGain * output * gain);
+                        }
+                    }
+
+                    for (size_t v = 0; v < vectorsPerGroup; ++v)
+                    {
+                        FastMath::store(inputSums + v * vectorLanes, inputVectors[v]);
+                        FastMath::store(outputSums + v * vectorLanes, outputVectors[v]);
+                    }
+                }
+                else
+#endif
+                {
+                    for (; i + energyLanes <= chunkLength; i += energyLanes)
+                        for (size_t lane = 0; lane < energyLanes; ++lane)
+                            shapeSample(i + lane, lane);
+                }
+
+                for (; i < chunkLength; ++i)
+                    shapeSample(i, (chunkPosition + i) % energyLanes);
+            }
+
+            start += chunkLength;
+            chunkPosition += chunkLength;
+
+            if (chunkPosition == controlChunkSize)
+            {
+                currentGain = chunkStartGain + gainStep * static_cast<FloatType>(controlChunkSize);
+
+                const auto numValues = static_cast<FloatType>(controlChunkSize * numChannels);
+                updateEnvelope(inputEnergy, sumLanes(inputSums) / numValues);
+                updateEnvelope(outputEnergy, sumLanes(outputSums) / numValues);
+
+                std::fill(std::begin(inputSums), std::end(inputSums), FloatType(0));
+                std::fill(std::begin(outputSums), std::end(outputSums), FloatType(0));
+                chunkPosition = 0;
+            }
+        }
+    }
+
+    // Post gain, times sqrt(input energy / output energy) when compensating
+    FloatType getTargetGain() const noexcept
+    {
+        constexpr FloatType silence = FloatType(1.0e-12);
+
+        if (compensationEnabled && inputEnergy > silence && outputEnergy > silence)
+            return postGain * std::sqrt(inputEnergy / outputEnergy);
+
+        return postGain;
+    }
+
+    void updateEnvelope(FloatType& envelope, FloatType chunkEnergy) const noexcept
+    {
+        const auto coefficient = chunkEnergy > envelope ? attackCoefficient : releaseCoefficient;
+        envelope += coefficient * (chunkEnergy - envelope);
+    }
+
+    void updateBallistics()
+    {
+        // One-pole coefficients for an envelope stepped once per control chunk
+        auto coefficientFor = [this](float timeMs)
+        {
+            const auto timeInChunks = timeMs * 0.001 * sampleRate / static_cast<double>(controlChunkSize);
+            return static_cast<FloatType>(1.0 - std::exp(-1.0 / juce::jmax(timeInChunks, 1.0)));
+        };
+
+        attackCoefficient = coefficientFor(attackMs);
+        releaseCoefficient = coefficientFor(releaseMs);
+    }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+    using Vector = FastMath::Vector<FloatType>;
+    static constexpr size_t vectorLanes = FastMath::numLanes<FloatType>;
+
+    // A whole number of vectors, and never fewer than the 8 lanes the scalar loop uses
+    static constexpr size_t energyLanes = std::max<size_t>(8, vectorLanes);
+#else
+    static constexpr size_t energyLanes = 8;
+#endif
+
+    static FloatType sumLanes(const FloatType (&lanes)[energyLanes]) noexcept
+    {
+        return std::accumulate(std::begin(lanes), std::end(lanes), FloatType(0));
+    }
+
+    DistortionType type = DistortionType::SoftClipping;
+    ShaperQuality quality = ShaperQuality::Fast;
+    FloatType drive = 1;
+    float bitDepth = 0;
+    FloatType quantizationLevels = 1, quantizationStep = 1;
+
+    double sampleRate = 44100.0;
+    float attackMs = 10.0f, releaseMs = 150.0f;
+    FloatType attackCoefficient = 1, releaseCoefficient = 1;
+    bool compensationEnabled = true;
+    FloatType postGain = 1, currentGain = 1, mix = 1;
+    FloatType inputEnergy = 0, outputEnergy = 0;
+
+    // The chunk in progress, which may have started in an earlier call
+    size_t chunkPosition = 0;
+    FloatType chunkStartGain = 1, gainStep = 0;
+    FloatType inputSums[energyLanes] = {}, outputSums[energyLanes] = {};
+};
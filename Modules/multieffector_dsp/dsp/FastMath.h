@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Branch-free approximations of the transcendental functions used by the
+    waveshapers, for single samples and for whole vectors of them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Set to 0 to build the waveshapers without the vector kernels. They use the GCC and
+// Clang vector extensions, because juce::dsp::SIMDRegister has no division, so other
+// compilers get the scalar kernels on their own.
+#ifndef MULTIEFFECTOR_FASTMATH_VECTORS
+ #if defined(__GNUC__) || defined(__clang__)
+  #define MULTIEFFECTOR_FASTMATH_VECTORS 1
+ #else
+  #define MULTIEFFECTOR_FASTMATH_VECTORS 0
+ #endif
+#endif
+
+// Every function here is a straight line of multiplies, adds, min/max, selects and a
+// single divide, with no table lookups and no data-dependent branches. Each one is
+// written once against a small set of operations (see Scalar and Lanes below) and
+// comes in two forms: one sample at a time, and a Vector as wide as the target's
+// registers, which is 4 floats with SSE or NEON, 8 with AVX and 16 with AVX-512.
+// Neither form depends on the auto-vectoriser, which GCC won't apply to the scalar
+// form without -fno-trapping-math. Both do the same arithmetic in the same order,
+// so they only differ where the compiler fuses a multiply and add in one form and
+// not the other, by an ulp or so. The coefficients are single precision, so the
+// double versions have the same error as the float ones.
+namespace FastMath
+{
+
+namespace detail
+{
+template<typename FloatType>
+struct Scalar
+{
+    using Value = FloatType;
+
+    static Value constant(FloatType x) noexcept               { return x; }
+    static Value abs(Value x) noexcept                        { return std::abs(x); }
+    static Value min(Value a, Value b) noexcept               { return std::min(a, b); }
+    static Value copySign(Value magnitude, Value sign) noexcept { return std::copysign(magnitude, sign); }
+    static Value select(bool condition, Value a, Value b) noexcept { return condition ? a : b; }
+    static int truncate(Value x) noexcept                     { return static_cast<int>(x); }
+    static Value toFloat(int x) noexcept                      { return static_cast<FloatType>(x); }
+};
+} // namespace detail
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+// The native register width. Anything wider would be passed differently between
+// functions built with and without the wider instructions, and GCC warns about that.
+#if defined(__AVX512F__)
+constexpr size_t vectorBytes = 64;
+#elif defined(__AVX__)
+constexpr size_t vectorBytes = 32;
+#else
+constexpr size_t vectorBytes = 16;
+#endif
+
+template<typename FloatType>
+constexpr size_t numLanes = vectorBytes / sizeof(FloatType);
+
+template<typename FloatType> struct VectorTypes;
+template<> struct VectorTypes<float>  { typedef float Type __attribute__((vector_size(vectorBytes))); };
+template<> struct VectorTypes<double> { typedef double Type __attribute__((vector_size(vectorBytes))); };
+
+// numLanes samples, with the usual arithmetic operators working on every lane
+template<typename FloatType>
+using Vector = typename VectorTypes<FloatType>::Type;
+
+// Unaligned, so any sample in a channel can start a vector
+template<typename FloatType>
+inline Vector<FloatType> load(const FloatType* source) noexcept
+{
+    Vector<FloatType> result;
+    std::memcpy(&result, source, sizeof(result));
+    return result;
+}
+
+template<typename FloatType>
+inline void store(FloatType* destination, Vector<FloatType> value) noexcept
+{
+    std::memcpy(destination, &value, sizeof(value));
+}
+
+// 0, 1, 2, ... numLanes - 1
+template<typename FloatType>
+inline Vector<FloatType> laneIndices() noexcept
+{
+    Vector<FloatType> result;
+    for (size_t lane = 0; lane < numLanes<FloatType>; ++lane)
+        result[lane] = static_cast<FloatType>(lane);
+    return result;
+}
+
+namespace detail
+{
+// Comparisons give a mask with every bit of a lane set where they're true, which is
+// also the integer type the lanes are truncated to
+template<typename FloatType>
+struct Lanes
+{
+    using Value = Vector<FloatType>;
+    using Mask = decltype(Value{} < Value{});
+
+    static Value constant(FloatType x) noexcept { return x - Value{}; } // keeps -0.0
+    static Mask signBit() noexcept              { return (Mask) constant(FloatType(-0.0)); }
+
+    static Value abs(Value x) noexcept                          { return (Value) ((Mask) x & ~signBit()); }
+    static Value min(Value a, Value b) noexcept                 { return select(b < a, b, a); }
+    static Value copySign(Value magnitude, Value sign) noexcept { return (Value) (((Mask) magnitude & ~signBit()) | ((Mask) sign & signBit())); }
+    static Value select(Mask condition, Value a, Value b) noexcept { return (Value) ((condition & (Mask) a) | (~condition & (Mask) b)); }
+    static Mask truncate(Value x) noexcept                      { return __builtin_convertvector(x, Mask); }
+    static Value toFloat(Mask x) noexcept                       { return __builtin_convertvector(x, Value); }
+};
+} // namespace detail
+#endif
+
+namespace detail
+{
+// tanh(x) as a 13/6 odd rational function, with x clamped to the range where the
+// result rounds to +-1 in single precision
+template<typename Ops, typename FloatType>
+inline typename Ops::Value tanh(typename Ops::Value x) noexcept
+{
+    x = Ops::copySign(Ops::min(Ops::abs(x), Ops::constant(FloatType(7.90531110763549805))), x);
+
+    const auto x2 = x * x;
+
+    auto p = Ops::constant(FloatType(-2.76076847742355e-16));
+    p = p * x2 + FloatType(2.00018790482477e-13);
+    p = p * x2 + FloatType(-8.60467152213735e-11);
+    p = p * x2 + FloatType(5.12229709037114e-08);
+    p = p * x2 + FloatType(1.48572235717979e-05);
+    p = p * x2 + FloatType(6.37261928875436e-04);
+    p = p * x2 + FloatType(4.89352455891786e-03);
+    p = p * x;
+
+    auto q = Ops::constant(FloatType(1.19825839466702e-06));
+    q = q * x2 + FloatType(1.18534705686654e-04);
+    q = q * x2 + FloatType(2.26843463243900e-03);
+    q = q * x2 + FloatType(4.89352518554385e-03);
+
+    return p / q;
+}
+
+// atan(x) as an 11th order odd minimax polynomial on [0, 1]. Larger arguments are
+// folded in with atan(x) = pi/2 - atan(1/x), choosing the smaller of |x| and 1/|x|
+// instead of branching on it.
+template<typename Ops, typename FloatType>
+inline typename Ops::Value atan(typename Ops::Value x) noexcept
+{
+    const auto a = Ops::abs(x);
+    const auto z = Ops::min(a, FloatType(1) / a);
+    const auto z2 = z * z;
+
+    auto p = Ops::constant(FloatType(-0.01172120));
+    p = p * z2 + FloatType(0.05265332);
+    p = p * z2 + FloatType(-0.11643287);
+    p = p * z2 + FloatType(0.19354346);
+    p = p * z2 + FloatType(-0.33262347);
+    p = p * z2 + FloatType(0.99997726);
+    p = p * z;
+
+    const auto r = Ops::select(a > FloatType(1), FloatType(1.57079632679489662) - p, p);
+    return Ops::copySign(r, x);
+}
+
+// sin(x) reduced to [-pi/2, pi/2] by the nearest multiple of pi (two-part Cody-Waite
+// subtraction), then an 11th order odd polynomial, negated for odd multiples.
+// Arguments are clamped to +-1e6 so the multiple always fits in an int.
+template<typename Ops, typename FloatType>
+inline typename Ops::Value sin(typename Ops::Value x) noexcept
+{
+    x = Ops::copySign(Ops::min(Ops::abs(x), Ops::constant(FloatType(1.0e6))), x);
+
+    const auto k = Ops::truncate(x * FloatType(0.318309886183790672) + Ops::copySign(Ops::constant(FloatType(0.5)), x));
+    const auto kf = Ops::toFloat(k);
+
+    auto r = x - kf * FloatType(3.140625);
+    r = r - kf * FloatType(9.67653589793e-4);
+
+    const auto r2 = r * r;
+
+    auto p = Ops::constant(FloatType(-2.3889e-8));
+    p = p * r2 + FloatType(2.7525e-6);
+    p = p * r2 + FloatType(-1.984126e-4);
+    p = p * r2 + FloatType(8.333333186e-3);
+    p = p * r2 + FloatType(-1.6666666664e-1);
+    p = p * r2 * r + r;
+
+    return Ops::select((k & 1) != 0, -p, p);
+}
+
+// Adding and subtracting 2^23 (2^52 for double) rounds to the nearest integer, ties
+// to even; ties that went down are then bumped up, and magnitudes that are already
+// integers pass straight through
+template<typename Ops, typename FloatType>
+inline typename Ops::Value roundHalfAwayFromZero(typename Ops::Value x) noexcept
+{
+    constexpr auto integerThreshold = static_cast<FloatType>(1LL << (std::numeric_limits<FloatType>::digits - 1));
+
+    const auto a = Ops::abs(x);
+    auto r = (a + integerThreshold) - integerThreshold;
+    r = Ops::select(r - a == FloatType(-0.5), r + FloatType(1), r);
+    r = Ops::select(a < integerThreshold, r, a);
+
+    return Ops::copySign(r, x);
+}
+} // namespace detail
+
+// Max absolute error: 3.7e-7 for all x
+template<typename FloatType>
+inline FloatType tanh(FloatType x) noexcept { return detail::tanh<detail::Scalar<FloatType>, FloatType>(x); }
+
+// Max absolute error: 1.9e-6 rad for all x
+template<typename FloatType>
+inline FloatType atan(FloatType x) noexcept { return detail::atan<detail::Scalar<FloatType>, FloatType>(x); }
+
+// Max absolute error: 2e-7 for |x| <= 1e4
+template<typename FloatType>
+inline FloatType sin(FloatType x) noexcept { return detail::sin<detail::Scalar<FloatType>, FloatType>(x); }
+
+// std::round (halfway cases away from zero) without a libm call or a branch. Exact for
+// every input, but relies on the compiler not reassociating the add and subtract, so
+// don't build with -ffast-math.
+template<typename FloatType>
+inline FloatType roundHalfAwayFromZero(FloatType x) noexcept { return detail::roundHalfAwayFromZero<detail::Scalar<FloatType>, FloatType>(x); }
+
+#if MULTIEFFECTOR_FASTMATH_VECTORS
+inline Vector<float>  tanh(Vector<float> x) noexcept  { return detail::tanh<detail::Lanes<float>, float>(x); }
+inline Vector<double> tanh(Vector<double> x) noexcept { return detail::tanh<detail::Lanes<double>, double>(x); }
+inline Vector<float>  atan(Vector<float> x) noexcept  { return detail::atan<detail::Lanes<float>, float>(x); }
+inline Vector<double> atan(Vector<double> x) noexcept { return detail::atan<detail::Lanes<double>, double>(x); }
+inline Vector<float>  sin(Vector<float> x) noexcept   { return detail::sin<detail::Lanes<float>, float>(x); }
+inline Vector<double> sin(Vector<double> x) noexcept  { return detail::sin<detail::Lanes<double>, double>(x); }
+inline Vector<float>  roundHalfAwayFromZero(Vector<float> x) noexcept  { return detail::roundHalfAwayFromZero<detail::Lanes<float>, float>(x); }
+inline Vector<double> roundHalfAwayFromZero(Vector<double> x) noexcept { return detail::roundHalfAwayFromZero<detail::Lanes<double>, double>(x); }
+#endif
+
+} // namespace FastMath
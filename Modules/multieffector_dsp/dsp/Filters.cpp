@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    Filters.cpp
+    Implementation of the EQ.
+
+  ==============================================================================
+*/
+
+// How long an IIR section's impulse response takes to decay below silenceThreshold,
+// going by its slowest pole
+template<typename SampleType>
+double getDecaySeconds(const juce::dsp::IIR::Coefficients<SampleType>& coefficients, double sampleRate)
+{
+    const auto* c = coefficients.getRawCoefficients();
+    double radius = 0.0;
+
+    if (coefficients.getFilterOrder() == 1)
+    {
+        radius = std::abs((double) c[2]);
+    }
+    else if (coefficients.getFilterOrder() == 2)
+    {
+        const double a1 = c[3], a2 = c[4];
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+        radius = discriminant < 0.0 ? std::sqrt(a2) : 0.5 * (std::abs(a1) + std::sqrt(discriminant));
+    }
+
+    if (radius <= 0.0 || radius >= 1.0)
+        return 0.0;
+
+    return std::log((double) silenceThreshold) / std::log(radius) / sampleRate;
+}
+
+// The same for one Linkwitz-Riley filter, which is two Butterworth sections in series
+double getLinkwitzRileyDecaySeconds(float frequency)
+{
+    const auto damping = juce::MathConstants<double>::sqrt2 * 0.5;
+    const auto sectionSeconds = -std::log((double) silenceThreshold) / (damping * juce::MathConstants<double>::twoPi * frequency);
+    return 2.0 * sectionSeconds;
+}
+
+template<typename SampleType>
+std::unique_ptr<typename FilterCoefficientDesigner<SampleType>::CoefficientSet> FilterCoefficientDesigner<SampleType>::design(const ChainSettings& chainSettings, double sampleRate)
+{
+    auto set = std::make_unique<CoefficientSet>();
+    set->chainSettings = chainSettings;
+    set->sampleRate = sampleRate;
+    set->peak = makePeakFilter<SampleType>(chainSettings, sampleRate);
+    set->lowCut = makeLowCutFilter<SampleType>(chainSettings, sampleRate);
+    set->highCut = makeHighCutFilter<SampleType>(chainSettings, sampleRate);
+    
+    // Each stage rings on after the one before it. A peak with no gain does nothing.
+    if (chainSettings.peakGainInDeciibels != 0.0f)
+        set->tailSeconds += getDecaySeconds(*set->peak, sampleRate);
+    
+    for (auto* cut : { &set->lowCut, &set->highCut })
+        for (auto* stage : *cut)
+            set->tailSeconds += getDecaySeconds(*stage, sampleRate);
+    
+    // Gentler slopes produce fewer stages; fill the rest so applyTo() can always use four
+    for (auto* cut : { &set->lowCut, &set->highCut })
+        while (cut->size() < 4)
+            cut->add(cut->getFirst());
+    
+    return set;
+}
+
+template<typename SampleType>
+const typename FilterCoefficientDesigner<SampleType>::CoefficientSet& FilterCoefficientDesigner<SampleType>::prepare(const ChainSettings& chainSettings, double sampleRate)
+{
+    const juce::ScopedLock lock(buildLock);
+    
+    // The audio thread is stopped and the lock keeps the background thread out,
+    // so everything queued so far can be thrown away from here
+    Request staleRequest;
+    while (requests.pull(staleRequest)) {}
+    designs.clear();
+    
+    designs.reset(design(chainSettings, sampleRate));
+    lastRequest = { chainSettings, sampleRate };
+    return *designs.getCurrent();
+}
+
+template<typename SampleType>
+bool FilterCoefficientDesigner<SampleType>::isSameDesign(const Request& request, const ChainSettings& chainSettings, double sampleRate)
+{
+    const auto& previous = request.chainSettings;
+    return request.sampleRate == sampleRate
+        && previous.lowCutFreq == chainSettings.lowCutFreq
+        && previous.lowCutSlope == chainSettings.lowCutSlope
+        && previous.highCutFreq == chainSettings.highCutFreq
+        && previous.highCutSlope == chainSettings.highCutSlope
+        && previous.peakFreq == chainSettings.peakFreq
+        && previous.peakGainInDeciibels == chainSettings.peakGainInDeciibels
+        && previous.peakQuality == chainSettings.peakQuality;
+}
+
+template<typename SampleType>
+void FilterCoefficientDesigner<SampleType>::requestDesign(const ChainSettings& chainSettings, double sampleRate)
+{
+    if (isSameDesign(lastRequest, chainSettings, sampleRate))
+        return;
+    
+    Request request { chainSettings, sampleRate };
+    
+    // If the queue is full, try again next block
+    if (requests.push(request))
+        lastRequest = request;
+}
+
+template<typename SampleType>
+int FilterCoefficientDesigner<SampleType>::useTimeSlice()
+{
+    const juce::ScopedLock lock(buildLock);
+    designs.collectGarbage();
+    
+    // Only the most recent request matters
+    Request request;
+    bool hasRequest = false;
+    while (requests.pull(request))
+        hasRequest = true;
+    
+    if (hasRequest && request.sampleRate > 0.0)
+        designs.publish(design(request.chainSettings, request.sampleRate));
+    
+    return pollIntervalMs;
+}
+
+template<typename SampleType>
+void interleaveChannels(const juce::dsp::AudioBlock<SampleType>& source, const typename MultichannelEQ<SampleType>::InterleavedBlock& destination)
+{
+    constexpr auto numLanes = MultichannelEQ<SampleType>::SIMDSample::size();
+    const auto numChannels = juce::jmin(source.getNumChannels(), destination.getNumChannels() * numLanes);
+    const auto numSamples = source.getNumSamples();
+
+    jassert(source.getNumChannels() <= destination.getNumChannels() * numLanes && numSamples <= destination.getNumSamples());
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* lanes = reinterpret_cast<SampleType*>(destination.getChannelPointer(channel / numLanes));
+        const auto lane = channel % numLanes;
+        auto* channelData = source.getChannelPointer(channel);
+        for (size_t i = 0; i < numSamples; ++i)
+            lanes[i * numLanes + lane] = channelData[i];
+    }
+}
+
+template<typename SampleType>
+void deinterleaveChannels(const typename MultichannelEQ<SampleType>::InterleavedBlock& source, const juce::dsp::AudioBlock<SampleType>& destination)
+{
+    constexpr auto numLanes = MultichannelEQ<SampleType>::SIMDSample::size();
+    const auto numChannels = juce::jmin(destination.getNumChannels(), source.getNumChannels() * numLanes);
+    const auto numSamples = destination.getNumSamples();
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* lanes = reinterpret_cast<const SampleType*>(source.getChannelPointer(channel / numLanes));
+        const auto lane = channel % numLanes;
+        auto* channelData = destination.getChannelPointer(channel);
+        for (size_t i = 0; i < numSamples; ++i)
+            channelData[i] = lanes[i * numLanes + lane];
+    }
+}
+
+template<typename SampleType>
+void MultichannelEQ<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    auto groupSpec = spec;
+    groupSpec.numChannels = 1;
+
+    chains.resize(getNumGroups(spec.numChannels));
+    for (auto& chain : chains)
+        chain.prepare(groupSpec);
+}
+
+template<typename SampleType>
+void MultichannelEQ<SampleType>::reset()
+{
+    for (auto& chain : chains)
+        chain.reset();
+}
+
+template<typename SampleType>
+void MultichannelEQ<SampleType>::process(const InterleavedBlock& interleaved)
+{
+    const auto numGroups = juce::jmin(chains.size(), interleaved.getNumChannels());
+
+    for (size_t group = 0; group < numGroups; ++group)
+    {
+        auto groupBlock = interleaved.getSingleChannelBlock(group);
+        chains[group].process(juce::dsp::ProcessContextReplacing<SIMDSample>(groupBlock));
+    }
+}
+
+template struct MultichannelEQ<float>;
+template struct MultichannelEQ<double>;
+template class FilterCoefficientDesigner<float>;
+template class FilterCoefficientDesigner<double>;
+template double getDecaySeconds<float>(const juce::dsp::IIR::Coefficients<float>&, double);
+template double getDecaySeconds<double>(const juce::dsp::IIR::Coefficients<double>&, double);
+template void interleaveChannels<float>(const juce::dsp::AudioBlock<float>&, const MultichannelEQ<float>::InterleavedBlock&);
+template void interleaveChannels<double>(const juce::dsp::AudioBlock<double>&, const MultichannelEQ<double>::InterleavedBlock&);
+template void deinterleaveChannels<float>(const MultichannelEQ<float>::InterleavedBlock&, const juce::dsp::AudioBlock<float>&);
+template void deinterleaveChannels<double>(const MultichannelEQ<double>::InterleavedBlock&, const juce::dsp::AudioBlock<double>&);
\ No newline at end of file
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    Filters.h
+    The EQ: the filter chains, their coefficients, and the designer that
+    builds them off the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Below -120 dB counts as silence, for the input, the output and the decay of the tails
+constexpr float silenceThreshold = 1.0e-6f;
+
+// Defines Filter as an alias for the JUCE Infinite Impulse Response (IIR) filter,
+// which processes audio by applying various frequency-dependent effects like
+// low-pass, high-pass, or peak filters.
+using Filter = juce::dsp::IIR::Filter<float>;
+
+// A chain of four filters
+// Used to construct high-order filters by cascading multiple simple filters
+using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+
+// Consists of a low-cut, a peak, and a high-cut filter
+using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+// The EQ for any number of channels: one SIMDChain per group of SIMDSample::size()
+// channels, each running on its own channel of an interleaved block. The chain is the
+// MonoChain running on SIMD registers with one channel per lane, so every biquad runs
+// once per sample for a whole group of channels. In float, mono and stereo take one
+// group and 5.1 and 7.1 take two on SSE and NEON; a register holds half as many doubles.
+template<typename SampleType>
+struct MultichannelEQ
+{
+    using SIMDSample = juce::dsp::SIMDRegister<SampleType>;
+    using SIMDFilter = juce::dsp::IIR::Filter<SIMDSample>;
+    using SIMDCutFilter = juce::dsp::ProcessorChain<SIMDFilter, SIMDFilter, SIMDFilter, SIMDFilter>;
+    using SIMDChain = juce::dsp::ProcessorChain<SIMDCutFilter, SIMDFilter, SIMDCutFilter>;
+    using InterleavedBlock = juce::dsp::AudioBlock<SIMDSample>;
+    
+    static size_t getNumGroups(size_t numChannels) { return (numChannels + SIMDSample::size() - 1) / SIMDSample::size(); }
+    
+    // spec.numChannels is the number of audio channels, not groups
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+    void process(const InterleavedBlock& interleaved);
+    
+    std::vector<SIMDChain> chains;
+};
+
+// Copy channels into the lanes of an interleaved block and back. Channel c goes to
+// lane c % SIMDSample::size() of the block's channel c / SIMDSample::size(). Lanes
+// beyond the last channel are left alone (ScratchArena keeps them at zero).
+template<typename SampleType>
+void interleaveChannels(const juce::dsp::AudioBlock<SampleType>& source, const typename MultichannelEQ<SampleType>::InterleavedBlock& destination);
+template<typename SampleType>
+void deinterleaveChannels(const typename MultichannelEQ<SampleType>::InterleavedBlock& source, const juce::dsp::AudioBlock<SampleType>& destination);
+
+enum ChainPositions
+{
+    LowCut,
+    Peak,
+    HighCut
+};
+
+// The float coefficients, which is what the editor's MonoChain takes. The processing
+// chain takes coefficients of its own sample type, designed from the same functions.
+using Coefficients = Filter::CoefficientsPtr;
+using CutCoefficients = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+// Points a filter at a different coefficients object. This is a pointer swap, so on
+// the audio thread the caller has to make sure the old object is still referenced
+// somewhere else (FilterCoefficientDesigner keeps its sets alive until they're retired).
+template<typename CoefficientsPtr>
+void updateCoefficients(CoefficientsPtr& old, const CoefficientsPtr& replacements)
+{
+    old = replacements;
+}
+
+template<typename SampleType = float>
+typename juce::dsp::IIR::Coefficients<SampleType>::Ptr makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain((SampleType) chainSettings.peakGainInDeciibels));
+}
+
+// Updates the coefficients for a specific stage in the filter chain.
+// 'Index' determines which filter stage (e.g., stage 0, 1, 2, or 3) to update.
+// 'chain' is the filter chain containing the filter stages.
+// 'cutCoefficients' is an array of coefficient pointers, each corresponding to a filter stage.
+template<int Index, typename ChainType, typename CoefficientType>
+void update(ChainType& chain, const CoefficientType& cutCoefficients)
+{
+    // Replace the current coefficients of the filter stage with the new coefficients.
+    // This adjusts the filter's behavior (e.g., frequency, slope) for that stage.
+    updateCoefficients(chain.template get<Index>().coefficients, cutCoefficients[Index]);
+    // Enable the filter stage by setting its 'bypassed' state to 'false'.
+    // This ensures the updated filter stage becomes active in the audio processing chain.
+    chain.template setBypassed<Index>(false);
+}
+
+template<typename ChainType, typename CoefficientType>
+void updateCutFilter(ChainType& lowCut, const CoefficientType& cutCoefficient, const Slope& lowCutSlope)
+{
+    // Reset all filter stages to bypassed
+    // This ensures that no stages are active unless explicitly set below.
+    lowCut.template setBypassed<0>(true);
+    lowCut.template setBypassed<1>(true);
+    lowCut.template setBypassed<2>(true);
+    lowCut.template setBypassed<3>(true);
+    
+    switch(lowCutSlope)
+    {
+        case Slope_48:
+        {
+            update<3>(lowCut, cutCoefficient);
+            break;
+        }
+        case Slope_36:
+        {
+            update<2>(lowCut, cutCoefficient);
+            break;
+        }
+        case Slope_24:
+        {
+            update<1>(lowCut, cutCoefficient);
+            break;
+        }
+        case Slope_12:
+        {
+            update<0>(lowCut, cutCoefficient);
+            break;
+        }
+    }
+}
+
+template<typename SampleType = float>
+auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
+}
+
+template<typename SampleType = float>
+auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
+}
+
+// How long an IIR section's impulse response takes to decay below silenceThreshold,
+// going by its slowest pole
+template<typename SampleType>
+double getDecaySeconds(const juce::dsp::IIR::Coefficients<SampleType>& coefficients, double sampleRate);
+
+// The same for one Linkwitz-Riley filter, which is two Butterworth sections in series
+double getLinkwitzRileyDecaySeconds(float frequency);
+
+// Designs the EQ coefficients on the BackgroundDesignThread.
+// The audio thread calls requestDesign() every block, which only queues work when one of
+// the EQ parameters or the sample rate has moved since the last request, and then picks up
+// finished sets with getNewCoefficients(), which is just a pointer swap.
+template<typename SampleType>
+class FilterCoefficientDesigner : public juce::TimeSliceClient
+{
+public:
+    using CoefficientsPtr = typename juce::dsp::IIR::Coefficients<SampleType>::Ptr;
+    using CutCoefficientsArray = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<SampleType>>;
+    
+    struct CoefficientSet
+    {
+        ChainSettings chainSettings;
+        double sampleRate = 0.0;
+        CoefficientsPtr peak;
+        // Always four entries so every cut stage can point into this set
+        CutCoefficientsArray lowCut, highCut;
+        // How long the stages in use ring for after the input stops
+        double tailSeconds = 0.0;
+        
+        template<typename ChainType>
+        void applyTo(ChainType& chain) const
+        {
+            updateCoefficients(chain.template get<ChainPositions::Peak>().coefficients, peak);
+            applyToCutFilter(chain.template get<ChainPositions::LowCut>(), lowCut, chainSettings.lowCutSlope);
+            applyToCutFilter(chain.template get<ChainPositions::HighCut>(), highCut, chainSettings.highCutSlope);
+        }
+        
+        // Every group's chain shares the same coefficient objects
+        void applyTo(MultichannelEQ<SampleType>& eq) const
+        {
+            for (auto& chain : eq.chains)
+                applyTo(chain);
+        }
+    private:
+        template<typename CutFilterType>
+        static void applyToCutFilter(CutFilterType& cut, const CutCoefficientsArray& coefficients, Slope slope)
+        {
+            // Bypassed stages get this set's coefficients too, so no stage is left holding
+            // the last reference to an object from a set that has been retired.
+            updateCoefficients(cut.template get<0>().coefficients, coefficients[0]);
+            updateCoefficients(cut.template get<1>().coefficients, coefficients[1]);
+            updateCoefficients(cut.template get<2>().coefficients, coefficients[2]);
+            updateCoefficients(cut.template get<3>().coefficients, coefficients[3]);
+            updateCutFilter(cut, coefficients, slope);
+        }
+    };
+    
+    static std::unique_ptr<CoefficientSet> design(const ChainSettings& chainSettings, double sampleRate);
+    
+    // Designs a set straight away and makes it current, dropping any that were queued
+    // or being designed for the old rate. Call this from prepareToPlay.
+    const CoefficientSet& prepare(const ChainSettings& chainSettings, double sampleRate);
+    
+    // Audio thread
+    void requestDesign(const ChainSettings& chainSettings, double sampleRate);
+    // Sets designed for any rate but the one last asked for are stale. They are retired
+    // without ever becoming current, so the set in use stays the one to fade from.
+    const CoefficientSet* getNewCoefficients()
+    {
+        return designs.acquire([this](const CoefficientSet& set) { return set.sampleRate == lastRequest.sampleRate; });
+    }
+    
+    int useTimeSlice() override;
+private:
+    struct Request
+    {
+        ChainSettings chainSettings;
+        double sampleRate = 0.0;
+    };
+    
+    static bool isSameDesign(const Request& request, const ChainSettings& chainSettings, double sampleRate);
+    
+    static constexpr int pollIntervalMs = 10;
+    
+    // Held by prepare and while a set is designed and published, so nothing designed
+    // for the old rate can turn up after prepare returns
+    juce::CriticalSection buildLock;
+    Fifo<Request> requests;
+    RealtimeHandoff<CoefficientSet> designs;
+    Request lastRequest; // only touched by the audio thread (or prepare)
+};
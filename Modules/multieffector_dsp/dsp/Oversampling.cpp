@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Oversampling.cpp
+    Implementation of the oversampling designer.
+
+  ==============================================================================
+*/
+
+template<typename SampleType>
+OversamplingDesigner<SampleType>::Stage::Stage(const Setup& setupToUse, int numChannels, int maxBlockSize)
+    : setup(setupToUse),
+      oversampler((size_t) numChannels, (size_t) setup.order,
+                  setup.filter == OversamplingFilter::EquirippleFIR ? juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple
+                                                                    : juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                  true,  // max quality
+                  true)  // pad the latency to whole samples so it can be reported exactly
+{
+    oversampler.initProcessing((size_t) maxBlockSize);
+}
+
+template<typename SampleType>
+typename OversamplingDesigner<SampleType>::Stage& OversamplingDesigner<SampleType>::prepare(const Setup& setup, int numChannels, int maxBlockSize)
+{
+    const juce::ScopedLock lock(buildLock);
+    
+    // The audio thread is stopped and the lock keeps the background thread out,
+    // so everything queued so far can be thrown away from here
+    Request staleRequest;
+    while (requests.pull(staleRequest)) {}
+    stages.clear();
+    
+    stages.reset(std::make_unique<Stage>(setup, numChannels, maxBlockSize));
+    lastRequest = { setup, numChannels, maxBlockSize };
+    return *stages.getCurrent();
+}
+
+template<typename SampleType>
+void OversamplingDesigner<SampleType>::requestStage(const Setup& setup)
+{
+    if (lastRequest.setup == setup)
+        return;
+    
+    Request request { setup, lastRequest.numChannels, lastRequest.maxBlockSize };
+    
+    // If the queue is full, try again next block
+    if (requests.push(request))
+        lastRequest = request;
+}
+
+template<typename SampleType>
+int OversamplingDesigner<SampleType>::useTimeSlice()
+{
+    const juce::ScopedLock lock(buildLock);
+    stages.collectGarbage();
+    
+    // Only the most recent request matters
+    Request request;
+    bool hasRequest = false;
+    while (requests.pull(request))
+        hasRequest = true;
+    
+    if (hasRequest && request.maxBlockSize > 0)
+        stages.publish(std::make_unique<Stage>(request.setup, request.numChannels, request.maxBlockSize));
+    
+    return pollIntervalMs;
+}
+
+template class OversamplingDesigner<float>;
+template class OversamplingDesigner<double>;
\ No newline at end of file
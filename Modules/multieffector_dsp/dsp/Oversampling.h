@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    Oversampling.h
+    Builds the oversampling stage off the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// The oversampling factor and filter, the same whatever the sample type
+struct OversamplingSetup
+{
+    static constexpr int maxOrder = 3; // 8x
+    
+    int order = 1;
+    OversamplingFilter filter = OversamplingFilter::PolyphaseIIR;
+    
+    bool operator==(const OversamplingSetup& other) const { return order == other.order && filter == other.filter; }
+    bool operator!=(const OversamplingSetup& other) const { return ! (*this == other); }
+};
+
+// Builds oversamplers on the BackgroundDesignThread, since setting one up allocates and
+// designs its half-band filters. It works like FilterCoefficientDesigner: the audio
+// thread asks for a setup every block, which only queues work when the setup changed,
+// and picks up finished oversamplers with getNewStage().
+template<typename SampleType>
+class OversamplingDesigner : public juce::TimeSliceClient
+{
+public:
+    using Setup = OversamplingSetup;
+    static constexpr int maxOrder = Setup::maxOrder;
+    
+    struct Stage
+    {
+        Stage(const Setup& setupToUse, int numChannels, int maxBlockSize);
+        
+        int getFactor() const { return 1 << setup.order; }
+        // At the host rate. The oversampler pads itself to a whole number of samples.
+        int getLatencyInSamples() const { return juce::roundToInt(oversampler.getLatencyInSamples()); }
+        
+        Setup setup;
+        juce::dsp::Oversampling<SampleType> oversampler;
+    };
+    
+    // Builds a stage straight away and makes it current, dropping any that were queued
+    // or being built for the old channel count or block size. Call this from prepareToPlay.
+    Stage& prepare(const Setup& setup, int numChannels, int maxBlockSize);
+    
+    // Audio thread
+    void requestStage(const Setup& setup);
+    Stage* getNewStage() { return stages.acquire(); }
+    
+    int useTimeSlice() override;
+private:
+    struct Request
+    {
+        Setup setup;
+        int numChannels = 0;
+        int maxBlockSize = 0;
+    };
+    
+    static constexpr int pollIntervalMs = 10;
+    
+    // Held by prepare and while a stage is built and published, so nothing sized for
+    // the old channel count or block size can turn up after prepare returns
+    juce::CriticalSection buildLock;
+    Fifo<Request> requests;
+    RealtimeHandoff<Stage> stages;
+    Request lastRequest; // only touched by the audio thread (or prepare)
+};
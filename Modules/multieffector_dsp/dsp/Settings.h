@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Settings.h
+    The settings the signal path is configured with, independent of any
+    parameter tree.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum DistortionType
+{
+    SoftClipping,
+    HardClipping,
+    ArcTan,
+    BitCrusher,
+    SineFolding
+};
+
+// Exact uses the libm functions, Fast the branch-free approximations in FastMath.h,
+// and the Table qualities interpolate the curves precomputed in ShaperTables
+enum ShaperQuality
+{
+    Exact,
+    Fast,
+    TableLinear,
+    TableCubic
+};
+
+// LinkwitzRiley splits with CrossoverFilters, which adds no latency but shifts the
+// phase around each crossover. LinearPhase uses LinearPhaseCrossover, which keeps the
+// phase intact at the cost of latency.
+enum CrossoverMode
+{
+    LinkwitzRiley,
+    LinearPhase
+};
+
+// Half-band filters for the oversampler. PolyphaseIIR is cheap and adds little latency
+// but shifts the phase near Nyquist, EquirippleFIR is linear phase with more latency.
+enum OversamplingFilter
+{
+    PolyphaseIIR,
+    EquirippleFIR
+};
+
+// Number of bands the crossover splits the signal into, from 2 to 8. Everything
+// per band (parameters, filters, buffers, distortion states) is sized from this.
+#ifndef MULTIEFFECTOR_NUM_BANDS
+ #define MULTIEFFECTOR_NUM_BANDS 3
+#endif
+
+constexpr int numBands = MULTIEFFECTOR_NUM_BANDS;
+constexpr int numCrossovers = numBands - 1;
+static_assert(numBands >= 2 && numBands <= 8, "MULTIEFFECTOR_NUM_BANDS must be between 2 and 8");
+
+struct BandSettings {
+    DistortionType type{ DistortionType::SoftClipping };
+    float drive{ 0.0f }, postGain{ 0.0f }, mix{ 100.0f };
+};
+
+// What a band's settings do to it. An Inactive band (no drive, or a fully dry mix) comes
+// out of the crossover untouched, so processBlock skips its distortion, and only needs
+// the oversampled path at all while some band is Nonlinear. There is deliberately no
+// third, linear-only state between the two: the post gain only scales the shaped
+// signal, so no setting leaves a band linear but changed.
+enum BandActivity
+{
+    Inactive,
+    Nonlinear
+};
+
+inline BandActivity getBandActivity(const BandSettings& band)
+{
+    return band.drive > 0.0f && band.mix > 0.0f ? BandActivity::Nonlinear : BandActivity::Inactive;
+}
+
+struct ChainSettings
+{
+    float peakFreq {0}, peakGainInDeciibels{0}, peakQuality{1.f};
+    float lowCutFreq{0}, highCutFreq{0};
+    Slope lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
+    bool levelCompensation {true};
+    float compensationAttackMs {10.0f}, compensationReleaseMs {150.0f};
+    DistortionType distortionType {DistortionType::SoftClipping};
+    ShaperQuality shaperQuality {ShaperQuality::Fast};
+    int oversamplingOrder {1}; // runs at 2^order times the host rate
+    OversamplingFilter oversamplingFilter {OversamplingFilter::PolyphaseIIR};
+    CrossoverMode crossoverMode {CrossoverMode::LinkwitzRiley};
+    bool parallelBands {false};
+    int parallelThreshold {1024}; // smallest host block that goes to the worker pool
+    int controlBlockSize {32};    // host samples between parameter updates, see ControlBlocks
+    std::array<float, numCrossovers> crossovers{}; // ascending
+    std::array<BandSettings, numBands> bands;      // lowest band first
+};
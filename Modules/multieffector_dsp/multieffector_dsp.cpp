@@ -0,0 +1,37 @@
+#ifdef MULTIEFFECTOR_DSP_H_INCLUDED
+ /* When you add this cpp file to your project, you mustn't include it in a file where you've
+    already included any other headers - just put it inside a file on its own, possibly with your config
+    flags preceding it, but don't include anything else. That also includes avoiding any automatic prefix
+    header files that the compiler may be using.
+ */
+ #error "Incorrect use of JUCE cpp file"
+#endif
+
+#include "multieffector_dsp.h"
+
+// For the WakeSemaphore in Realtime.cpp
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <malloc.h> // _aligned_malloc, for the allocation check
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+#include <thread>
+#include <new>
+
+#include "utilities/Realtime.cpp"
+#include "utilities/ScratchArena.cpp"
+#include "utilities/StageTimings.cpp"
+#include "utilities/DeadlineMonitor.cpp"
+#include "dsp/ControlBlocks.cpp"
+#include "dsp/Distortion.cpp"
+#include "dsp/Filters.cpp"
+#include "dsp/Crossovers.cpp"
+#include "dsp/Oversampling.cpp"
+#include "dsp/BypassPath.cpp"
@@ -0,0 +1,51 @@
+/*******************************************************************************
+ The block below describes the properties of this module, and is read by
+ the Projucer to automatically generate project code that uses it.
+
+ BEGIN_JUCE_MODULE_DECLARATION
+
+  ID:                 multieffector_dsp
+  vendor:             ScottWu
+  version:            1.0.0
+  name:               3BandMultiEffector DSP
+  description:        The 3BandMultiEffector signal path, without the plugin around it
+  minimumCppStandard: 17
+
+  dependencies:       juce_core, juce_audio_basics, juce_dsp
+
+ END_JUCE_MODULE_DECLARATION
+
+*******************************************************************************/
+
+// Everything the plugin runs on the audio thread, split out of PluginProcessor.h so it
+// builds without juce_audio_processors or any of the GUI modules. The plugin, the
+// tools and the DSPCore static library all use it through this module.
+
+#pragma once
+#define MULTIEFFECTOR_DSP_H_INCLUDED
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+#include "utilities/Fifos.h"
+#include "dsp/Settings.h"
+#include "dsp/ControlBlocks.h"
+#include "dsp/FastMath.h"
+#include "dsp/Distortion.h"
+#include "utilities/ScratchArena.h"
+#include "utilities/Realtime.h"
+#include "utilities/StageTimings.h"
+#include "utilities/DeadlineMonitor.h"
+#include "dsp/Filters.h"
+#include "dsp/Crossovers.h"
+#include "dsp/Oversampling.h"
+#include "dsp/BypassPath.h"
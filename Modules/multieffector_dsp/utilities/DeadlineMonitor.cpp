@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    DeadlineMonitor.cpp
+    Implementation of the processing deadline histogram.
+
+  ==============================================================================
+*/
+
+double DeadlineMonitor::getBinStart(int bin)
+{
+    if (bin <= 0)
+        return 0.0;
+
+    return std::exp2(lowestOctave + (double) (bin - 1) / binsPerOctave);
+}
+
+void DeadlineMonitor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    secondsPerTick = juce::Time::highResolutionTicksToSeconds(1);
+}
+
+void DeadlineMonitor::record(juce::int64 elapsedTicks, int numSamples) noexcept
+{
+    const auto rate = sampleRate.load(std::memory_order_relaxed);
+    if (rate <= 0.0)
+        return;
+
+    const auto fraction = (double) elapsedTicks * secondsPerTick.load(std::memory_order_relaxed) * rate / numSamples;
+
+    auto bin = 0;
+    if (fraction > 0.0)
+    {
+        const auto octaves = std::log2(fraction) - lowestOctave;
+        bin = octaves < 0.0 ? 0 : juce::jmin(numBins - 1, 1 + (int) (octaves * binsPerOctave));
+    }
+
+    counts[(size_t) bin].fetch_add(1, std::memory_order_relaxed);
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    if (fraction > 0.5)  overHalf.fetch_add(1, std::memory_order_relaxed);
+    if (fraction > 0.8)  over80Percent.fetch_add(1, std::memory_order_relaxed);
+    if (fraction > 1.0)  overruns.fetch_add(1, std::memory_order_relaxed);
+
+    // Only this thread raises it and reset() only clears it, so a plain compare is enough
+    if ((float) fraction > worstFraction.load(std::memory_order_relaxed))
+        worstFraction.store((float) fraction, std::memory_order_relaxed);
+}
+
+DeadlineMonitor::Snapshot DeadlineMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+
+    for (size_t bin = 0; bin < counts.size(); ++bin)
+        snapshot.counts[bin] = counts[bin].load(std::memory_order_relaxed);
+
+    snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    snapshot.overHalf = overHalf.load(std::memory_order_relaxed);
+    snapshot.over80Percent = over80Percent.load(std::memory_order_relaxed);
+    snapshot.overruns = overruns.load(std::memory_order_relaxed);
+    snapshot.worstFraction = worstFraction.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void DeadlineMonitor::reset()
+{
+    for (auto& count : counts)
+        count = 0;
+
+    numBlocks = 0;
+    overHalf = 0;
+    over80Percent = 0;
+    overruns = 0;
+    worstFraction = 0.0f;
+}
+
+juce::String DeadlineMonitor::Snapshot::toText() const
+{
+    auto percent = [](double fraction) { return juce::String(fraction * 100.0, 2) + "%"; };
+    auto share = [this](juce::uint64 count) { return numBlocks > 0 ? juce::String(100.0 * (double) count / (double) numBlocks, 3) + "%" : juce::String("-"); };
+
+    juce::String text;
+    text << "Blocks: " << (juce::int64) numBlocks << juce::newLine
+         << "Over 50% of the deadline: " << (juce::int64) overHalf << " (" << share(overHalf) << ")" << juce::newLine
+         << "Over 80% of the deadline: " << (juce::int64) over80Percent << " (" << share(over80Percent) << ")" << juce::newLine
+         << "Missed the deadline: " << (juce::int64) overruns << " (" << share(overruns) << ")" << juce::newLine
+         << "Worst block: " << percent(worstFraction) << " of the deadline" << juce::newLine
+         << juce::newLine
+         << "From\tTo\tBlocks" << juce::newLine;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        text << percent(getBinStart(bin)) << "\t"
+             << (bin == numBins - 1 ? juce::String("-") : percent(getBinStart(bin + 1))) << "\t"
+             << (juce::int64) counts[(size_t) bin] << juce::newLine;
+    }
+
+    return text;
+}
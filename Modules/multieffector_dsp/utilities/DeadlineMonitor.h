@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    DeadlineMonitor.h
+    How long each processBlock takes compared with the time the host has to
+    deliver the block, kept as a lock-free histogram.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Every block's duration as a fraction of its deadline, numSamples / sampleRate,
+// counted into log-scale bins by the audio thread and read by the message thread.
+// Blocks past half the deadline, past 80% and past the whole deadline are counted
+// on their own as well, which is what to look at when a session glitches.
+class DeadlineMonitor
+{
+public:
+    // Quarter-octave bins from 1/256 of the deadline to 4 times it, with one more bin
+    // below and one above to catch everything else
+    static constexpr int binsPerOctave = 4;
+    static constexpr int lowestOctave = -8;
+    static constexpr int highestOctave = 2;
+    static constexpr int numBins = (highestOctave - lowestOctave) * binsPerOctave + 2;
+
+    // The smallest fraction of the deadline that lands in a bin
+    static double getBinStart(int bin);
+
+    // Not on the audio thread
+    void prepare(double sampleRate);
+
+    // Audio thread
+    void record(juce::int64 elapsedTicks, int numSamples) noexcept;
+
+    // Measures the enclosing scope as one block. Blocks of 0 samples aren't recorded,
+    // so pass 0 when rendering offline, where there's no deadline to meet.
+    struct ScopedBlock
+    {
+        ScopedBlock(DeadlineMonitor& monitorToUse, int numSamplesToRecord) noexcept
+            : monitor(monitorToUse), numSamples(numSamplesToRecord),
+              start(numSamples > 0 ? juce::Time::getHighResolutionTicks() : 0) {}
+        ~ScopedBlock() noexcept
+        {
+            if (numSamples > 0)
+                monitor.record(juce::Time::getHighResolutionTicks() - start, numSamples);
+        }
+
+        DeadlineMonitor& monitor;
+        const int numSamples;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    struct Snapshot
+    {
+        std::array<juce::uint64, numBins> counts{};
+        juce::uint64 numBlocks = 0, overHalf = 0, over80Percent = 0, overruns = 0;
+        float worstFraction = 0.0f;
+
+        // A plain text report, one line per bin
+        juce::String toText() const;
+    };
+
+    // Message thread
+    Snapshot getSnapshot() const;
+    void reset();
+private:
+    std::array<std::atomic<juce::uint64>, numBins> counts{};
+    std::atomic<juce::uint64> numBlocks { 0 }, overHalf { 0 }, over80Percent { 0 }, overruns { 0 };
+    std::atomic<float> worstFraction { 0.0f };
+    std::atomic<double> secondsPerTick { 0.0 }, sampleRate { 0.0 };
+};
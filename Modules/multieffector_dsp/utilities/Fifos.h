@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    Fifos.h
+    Lock-free fifos for passing buffers between threads, and the per-channel
+    sample fifo the editor's analyser reads from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+template<typename T>
+struct Fifo
+{
+    void prepare(int numChannels, int numSamples)
+    {
+        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
+                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
+        for( auto& buffer : buffers)
+        {
+            buffer.setSize(numChannels,
+                           numSamples,
+                           false,   //clear everything?
+                           true,    //including the extra space?
+                           true);   //avoid reallocating if you can?
+            buffer.clear();
+        }
+    } 
+    
+    void prepare(size_t numElements)
+    {
+        static_assert( std::is_same_v<T, std::vector<float>>,
+                      "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
+        for( auto& buffer : buffers )
+        {
+            buffer.clear();
+            buffer.resize(numElements, 0);
+        }
+    }
+    
+    bool push(const T& t)
+    {
+        auto write = fifo.write(1);
+        if( write.blockSize1 > 0 )
+        {
+            buffers[write.startIndex1] = t;
+            return true;
+        }
+        
+        return false;
+    }
+    
+    bool pull(T& t)
+    {
+        auto read = fifo.read(1);
+        if( read.blockSize1 > 0 )
+        {
+            t = buffers[read.startIndex1];
+            return true;
+        }
+        
+        return false;
+    }
+    
+    int getNumAvailableForReading() const
+    {
+        return fifo.getNumReady();
+    }
+    
+    int getNumAvailableForWriting() const
+    {
+        return fifo.getFreeSpace();
+    }
+private:
+    static constexpr int Capacity = 30;
+    std::array<T, Capacity> buffers;
+    juce::AbstractFifo fifo {Capacity};
+};
+
+enum Channel
+{
+    Right, //effectively 0
+    Left //effectively 1
+};
+
+template<typename BlockType>
+struct SingleChannelSampleFifo
+{
+    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
+    {
+        prepared.set(false);
+    }
+    
+    // Takes a buffer of any sample type, so the double precision path feeds the same
+    // fifo; each sample is converted on the way in
+    template<typename SourceBufferType>
+    void update(const SourceBufferType& buffer)
+    {
+        jassert(prepared.get());
+        jassert(buffer.getNumChannels() > 0);
+        // A mono buffer feeds both fifos from its only channel
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int) channelToUse, buffer.getNumChannels() - 1));
+        
+        for( int i = 0; i < buffer.getNumSamples(); ++i )
+        {
+            pushNextSampleIntoFifo(static_cast<float>(channelPtr[i]));
+        }
+    }
+
+    void prepare(int bufferSize)
+    {
+        prepared.set(false);
+        size.set(bufferSize);
+        
+        bufferToFill.setSize(1,             //channel
+                             bufferSize,    //num samples
+                             false,         //keepExistingContent
+                             true,          //clear extra space
+                             true);         //avoid reallocating
+        audioBufferFifo.prepare(1, bufferSize);
+        fifoIndex = 0;
+        prepared.set(true);
+    }
+    //==============================================================================
+    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+    bool isPrepared() const { return prepared.get(); }
+    int getSize() const { return size.get(); }
+    //==============================================================================
+    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+private:
+    Channel channelToUse;
+    int fifoIndex = 0;
+    Fifo<BlockType> audioBufferFifo;
+    BlockType bufferToFill;
+    juce::Atomic<bool> prepared = false;
+    juce::Atomic<int> size = 0;
+    
+    void pushNextSampleIntoFifo(float sample)
+    {
+        if (fifoIndex == bufferToFill.getNumSamples())
+        {
+            auto ok = audioBufferFifo.push(bufferToFill);
+
+            juce::ignoreUnused(ok);
+            
+            fifoIndex = 0;
+        }
+        
+        bufferToFill.setSample(0, fifoIndex, sample);
+        ++fifoIndex;
+    }
+};
@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    Realtime.cpp
+    Implementation of the realtime helpers.
+
+  ==============================================================================
+*/
+
+#if MULTIEFFECTOR_WRAP_MALLOC
+extern "C" void* __real_malloc(std::size_t size);
+extern "C" void* __real_calloc(std::size_t count, std::size_t size);
+extern "C" void* __real_realloc(void* ptr, std::size_t size);
+#endif
+
+#if MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+static thread_local int allocationCheckDepth = 0;
+static std::atomic<int> numAllocationViolations { 0 };
+
+ScopedAudioThreadAllocationCheck::ScopedAudioThreadAllocationCheck()  { ++allocationCheckDepth; }
+ScopedAudioThreadAllocationCheck::~ScopedAudioThreadAllocationCheck() { --allocationCheckDepth; }
+int ScopedAudioThreadAllocationCheck::getNumViolations() noexcept      { return numAllocationViolations.load(); }
+
+static void checkAllocation() noexcept
+{
+    if (allocationCheckDepth > 0)
+    {
+        // Something allocated inside processBlock, check the call stack.
+        // The depth is cleared while asserting because logging the assertion allocates too.
+        auto depth = std::exchange(allocationCheckDepth, 0);
+        ++numAllocationViolations;
+        jassertfalse;
+        allocationCheckDepth = depth;
+    }
+}
+
+// The C allocator itself, past the --wrap check when there is one
+static void* allocateUnchecked(std::size_t size) noexcept
+{
+   #if MULTIEFFECTOR_WRAP_MALLOC
+    return __real_malloc(size == 0 ? 1 : size);
+   #else
+    return std::malloc(size == 0 ? 1 : size);
+   #endif
+}
+
+static void* allocateAlignedUnchecked(std::size_t size, std::align_val_t alignment) noexcept
+{
+    const auto bytes = size == 0 ? 1 : size;
+    const auto alignTo = juce::jmax((std::size_t) alignment, sizeof(void*));
+
+   #if JUCE_WINDOWS
+    return _aligned_malloc(bytes, alignTo);
+   #else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignTo, bytes) == 0 ? ptr : nullptr;
+   #endif
+}
+
+static void freeAligned(void* ptr) noexcept
+{
+   #if JUCE_WINDOWS
+    _aligned_free(ptr);
+   #else
+    std::free(ptr);
+   #endif
+}
+
+static void* allocateWithCheck(std::size_t size)
+{
+    checkAllocation();
+
+    if (auto* ptr = allocateUnchecked(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+static void* allocateAlignedWithCheck(std::size_t size, std::align_val_t alignment)
+{
+    checkAllocation();
+
+    if (auto* ptr = allocateAlignedUnchecked(size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size)                                    { return allocateWithCheck(size); }
+void* operator new[](std::size_t size)                                  { return allocateWithCheck(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept    { checkAllocation(); return allocateUnchecked(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept  { checkAllocation(); return allocateUnchecked(size); }
+void operator delete(void* ptr) noexcept                                { std::free(ptr); }
+void operator delete[](void* ptr) noexcept                              { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept                   { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept                 { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept         { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept       { std::free(ptr); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)        { return allocateAlignedWithCheck(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment)      { return allocateAlignedWithCheck(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { checkAllocation(); return allocateAlignedUnchecked(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { checkAllocation(); return allocateAlignedUnchecked(size, alignment); }
+void operator delete(void* ptr, std::align_val_t) noexcept                          { freeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept                        { freeAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept             { freeAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept           { freeAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept   { freeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(ptr); }
+#elif MULTIEFFECTOR_WRAP_MALLOC
+static void checkAllocation() noexcept {}
+#endif
+
+#if MULTIEFFECTOR_WRAP_MALLOC
+extern "C" void* __wrap_malloc(std::size_t size)                  { checkAllocation(); return __real_malloc(size); }
+extern "C" void* __wrap_calloc(std::size_t count, std::size_t size) { checkAllocation(); return __real_calloc(count, size); }
+extern "C" void* __wrap_realloc(void* ptr, std::size_t size)      { checkAllocation(); return __real_realloc(ptr, size); }
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+WakeSemaphore::WakeSemaphore() : handle(dispatch_semaphore_create(0)) {}
+WakeSemaphore::~WakeSemaphore() { dispatch_release((dispatch_semaphore_t) handle); }
+
+void WakeSemaphore::post(int count)
+{
+    while (--count >= 0)
+        dispatch_semaphore_signal((dispatch_semaphore_t) handle);
+}
+
+void WakeSemaphore::wait() { dispatch_semaphore_wait((dispatch_semaphore_t) handle, DISPATCH_TIME_FOREVER); }
+#elif JUCE_WINDOWS
+WakeSemaphore::WakeSemaphore() : handle(CreateSemaphoreW(nullptr, 0, std::numeric_limits<LONG>::max(), nullptr)) {}
+WakeSemaphore::~WakeSemaphore() { CloseHandle(handle); }
+void WakeSemaphore::post(int count) { ReleaseSemaphore(handle, (LONG) count, nullptr); }
+void WakeSemaphore::wait() { WaitForSingleObject(handle, INFINITE); }
+#else
+WakeSemaphore::WakeSemaphore() : handle(new sem_t())
+{
+    sem_init((sem_t*) handle, 0, 0);
+}
+
+WakeSemaphore::~WakeSemaphore()
+{
+    sem_destroy((sem_t*) handle);
+    delete (sem_t*) handle;
+}
+
+void WakeSemaphore::post(int count)
+{
+    while (--count >= 0)
+        sem_post((sem_t*) handle);
+}
+
+void WakeSemaphore::wait()
+{
+    while (sem_wait((sem_t*) handle) != 0 && errno == EINTR)
+        {}
+}
+#endif
+
+WorkerPool::~WorkerPool()
+{
+    prepare(0);
+}
+
+void WorkerPool::prepare(int newNumWorkers)
+{
+    const juce::ScopedLock lock(prepareLock);
+
+    newNumWorkers = juce::jmax(0, newNumWorkers);
+    if (newNumWorkers == workers.size())
+        return;
+
+    // The audio thread stops handing out batches to a pool that's going away
+    numWorkers.store(0);
+
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    // One post for every worker that might be asleep, or about to be. Any left over
+    // just wake the next workers once for nothing.
+    wakeUp.post(workers.size());
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+
+    workers.clear();
+    sleepingWorkers.store(0);
+
+    for (int i = 0; i < newNumWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this));
+
+        // Without the permission for realtime scheduling, as on most Linux desktops,
+        // the highest normal priority is the next best thing
+        if (! worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+            worker->startThread(juce::Thread::Priority::highest);
+    }
+
+    numWorkers.store(newNumWorkers);
+}
+
+void WorkerPool::run(Batch& batch, int numJobs)
+{
+    jassert(numJobs > 0 && numJobs <= 0xffff);
+
+    // Nothing from the last batch is still running, so these can't be read by a job
+    // from it. The store of the new generation publishes them to the workers.
+    currentBatch.store(&batch, std::memory_order_relaxed);
+    unfinishedJobs.store(numJobs, std::memory_order_relaxed);
+
+    // Sequentially consistent, along with the worker's side in Worker::run, so either
+    // a worker going to sleep sees the new generation, or this sees it going to sleep
+    const auto generation = getGeneration(state.load(std::memory_order_relaxed)) + 1;
+    state.store(((juce::uint64) generation << 32) | ((juce::uint64) numJobs << 16));
+
+    if (const auto numSleeping = sleepingWorkers.exchange(0))
+        wakeUp.post(numSleeping);
+
+    helpWith(generation);
+
+    // Whatever is left is already running on a worker
+    for (int spins = 0; unfinishedJobs.load(std::memory_order_acquire) > 0; ++spins)
+    {
+        if (spins < maxSpins)
+            pause();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void WorkerPool::pause() noexcept
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+    __asm__ __volatile__ ("yield");
+   #endif
+}
+
+void WorkerPool::helpWith(juce::uint32 generation)
+{
+    auto current = state.load(std::memory_order_acquire);
+
+    while (getGeneration(current) == generation && getNextJob(current) < getNumJobs(current))
+    {
+        if (! state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        // The batch can't finish, and so can't be replaced, before this job does
+        currentBatch.load(std::memory_order_relaxed)->runJob(getNextJob(current));
+        unfinishedJobs.fetch_sub(1, std::memory_order_release);
+        ++current;
+    }
+}
+
+void WorkerPool::Worker::run()
+{
+    juce::ScopedNoDenormals noDenormals;
+    auto lastGeneration = getGeneration(pool.state.load());
+    int spins = 0;
+
+    while (! threadShouldExit())
+    {
+        const auto generation = getGeneration(pool.state.load(std::memory_order_acquire));
+
+        if (generation != lastGeneration)
+        {
+            lastGeneration = generation;
+            pool.helpWith(generation);
+            spins = 0;
+        }
+        else if (spins < maxSpins)
+        {
+            pause();
+            ++spins;
+        }
+        else
+        {
+            // If run() starts a batch after this, it sees this worker in sleepingWorkers
+            // and posts. Going back round after a post that came too early is harmless.
+            pool.sleepingWorkers.fetch_add(1);
+
+            if (getGeneration(pool.state.load()) == lastGeneration && ! threadShouldExit())
+                pool.wakeUp.wait();
+
+            spins = 0;
+        }
+    }
+}
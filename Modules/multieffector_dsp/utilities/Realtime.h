@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    Realtime.h
+    Helpers for keeping the audio thread free of allocations and locks:
+    handing objects over from background threads, the shared background
+    thread itself, and a pool of workers the audio thread can fan out to.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Debug aid for keeping processBlock allocation-free. While one of these is alive,
+// any allocation on the same thread hits a jassert: every form of global operator new,
+// and, where MULTIEFFECTOR_WRAP_MALLOC is set, malloc, calloc and realloc too, which
+// juce::HeapBlock (and so AudioBuffer) calls directly. It only does anything when
+// MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS is set to 1 (the .jucer sets it for the
+// debug configurations), otherwise it compiles away.
+#ifndef MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+ #define MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS 0
+#endif
+
+// Linux only. Set to 1 when linking with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,
+// which sends the program's own calls to those through the check. The .jucer's Linux
+// exporters for the plugin and the tools set both. The DSPCore library mustn't, as
+// whatever links it would need the linker flags as well.
+#ifndef MULTIEFFECTOR_WRAP_MALLOC
+ #define MULTIEFFECTOR_WRAP_MALLOC 0
+#endif
+
+struct ScopedAudioThreadAllocationCheck
+{
+   #if MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+    ScopedAudioThreadAllocationCheck();
+    ~ScopedAudioThreadAllocationCheck();
+    
+    // How many allocations have hit the check so far, on any thread
+    static int getNumViolations() noexcept;
+   #endif
+};
+
+// Passes objects built on a background thread to the audio thread without locking.
+// The background thread publishes new objects, the audio thread swaps to the newest
+// one and retires the one it was using, and the background thread deletes retired
+// objects later, so nothing is allocated or freed on the audio thread.
+// The object before the current one is only retired at the following swap, so the
+// audio thread can still read it while crossfading from it.
+template<typename ObjectType>
+struct RealtimeHandoff
+{
+    ~RealtimeHandoff() { clear(); }
+    
+    // Background thread: hand over a new object. If the audio thread has fallen too
+    // far behind to take it, it's dropped here instead.
+    void publish(std::unique_ptr<ObjectType> object)
+    {
+        if (pending.push(object.get()))
+            object.release();
+    }
+    
+    // Background thread: delete everything the audio thread has finished with.
+    void collectGarbage()
+    {
+        ObjectType* object = nullptr;
+        while (retired.pull(object))
+            delete object;
+    }
+    
+    // Audio thread: swap to the newest published object. Returns nullptr if nothing
+    // new has arrived since the last call.
+    ObjectType* acquire()
+    {
+        return acquire([](const ObjectType&) { return true; });
+    }
+    
+    // Audio thread: the same, but only objects isUsable returns true for can become
+    // current. The others are retired unseen, leaving current and previous as they were.
+    template<typename Predicate>
+    ObjectType* acquire(Predicate&& isUsable)
+    {
+        ObjectType* newest = nullptr;
+        ObjectType* next = nullptr;
+        
+        // Only take objects while there is room to retire both them and the current one
+        while (retired.getNumAvailableForWriting() > 1 && pending.pull(next))
+        {
+            if (! isUsable(static_cast<const ObjectType&>(*next)))
+            {
+                retired.push(next);
+                continue;
+            }
+            
+            if (newest != nullptr)
+                retired.push(newest);
+            newest = next;
+        }
+        
+        if (newest == nullptr)
+            return nullptr;
+        
+        if (previous != nullptr)
+            retired.push(previous);
+        
+        previous = current;
+        current = newest;
+        return current;
+    }
+    
+    // Audio thread: the object returned by the last successful acquire()
+    ObjectType* getCurrent() const { return current; }
+    
+    // Audio thread: the object that was current before it, or nullptr
+    ObjectType* getPrevious() const { return previous; }
+    
+    // Replaces the current object directly and drops the previous one. Only call this
+    // while the audio thread is stopped, e.g. from prepareToPlay.
+    void reset(std::unique_ptr<ObjectType> object)
+    {
+        delete previous;
+        previous = nullptr;
+        delete current;
+        current = object.release();
+    }
+    
+    // Deletes everything. Only call this once neither thread is using the handoff.
+    void clear()
+    {
+        ObjectType* object = nullptr;
+        while (pending.pull(object))
+            delete object;
+        collectGarbage();
+        reset(nullptr);
+    }
+private:
+    Fifo<ObjectType*> pending, retired;
+    ObjectType* current = nullptr;
+    ObjectType* previous = nullptr;
+};
+
+// One thread shared by every instance in the process, for work that has to stay off
+// the audio thread, like designing filters.
+struct BackgroundDesignThread : juce::TimeSliceThread
+{
+    BackgroundDesignThread() : juce::TimeSliceThread("3BandMultiEffector Designer") { startThread(); }
+    ~BackgroundDesignThread() override { stopThread(1000); }
+};
+
+// A counting semaphore on the platform's own primitive (dispatch, Win32 or POSIX).
+// Posting is an atomic increment plus, only if someone is waiting, a kernel wake-up,
+// so unlike juce::WaitableEvent it takes no mutex on the posting thread.
+class WakeSemaphore
+{
+public:
+    WakeSemaphore();
+    ~WakeSemaphore();
+    
+    // Lets count waiting threads through, now or at their next wait()
+    void post(int count);
+    void wait();
+private:
+    void* handle = nullptr;
+    
+    JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+};
+
+// Worker threads that help the audio thread through a batch of independent jobs, such
+// as the band distortions between the crossover split and the sum. The threads run at
+// realtime priority where the system allows it. After a batch they spin for a moment
+// in case another follows, then sleep on a WakeSemaphore, which run() only posts to if
+// a worker is actually asleep. Every thread, the caller included, claims the next
+// unclaimed job with a compare-and-swap until none are left, so a worker that wakes
+// late just finds less to do and the audio thread never waits for a job to be
+// claimed. It only waits for the jobs already running elsewhere to finish, spinning
+// for a bounded time and then yielding, in case one of them was preempted.
+class WorkerPool
+{
+public:
+    struct Batch
+    {
+        virtual ~Batch() = default;
+        virtual void runJob(int index) = 0;
+    };
+    
+    ~WorkerPool();
+    
+    // Stops the current workers and starts numWorkers new ones, unless that many are
+    // already running. Not on the audio thread, which can go on running batches meanwhile:
+    // a job a stopping worker has claimed is finished first, and the rest are left to
+    // the audio thread.
+    void prepare(int numWorkers);
+    int getNumWorkers() const { return numWorkers.load(std::memory_order_relaxed); }
+    
+    // Audio thread
+    void run(Batch& batch, int numJobs);
+private:
+    struct Worker : juce::Thread
+    {
+        explicit Worker(WorkerPool& owner) : juce::Thread("3BandMultiEffector Worker"), pool(owner) {}
+        void run() override;
+        WorkerPool& pool;
+    };
+    
+    // Runs jobs from the given batch until they are all claimed, or a newer batch starts
+    void helpWith(juce::uint32 generation);
+    
+    // How many times a worker or the audio thread checks an atomic before giving up
+    // the CPU, about 20 to 50 microseconds of pause instructions
+    static constexpr int maxSpins = 1000;
+    static void pause() noexcept;
+    
+    static juce::uint32 getGeneration(juce::uint64 state) { return (juce::uint32) (state >> 32); }
+    static int getNumJobs(juce::uint64 state) { return (int) ((state >> 16) & 0xffff); }
+    static int getNextJob(juce::uint64 state) { return (int) (state & 0xffff); }
+    
+    juce::CriticalSection prepareLock;
+    juce::OwnedArray<Worker> workers; // only touched by prepare()
+    std::atomic<int> numWorkers { 0 };
+    
+    // The batch's generation, its number of jobs and the next unclaimed job, in one word
+    // so a job can only ever be claimed for the batch it belongs to
+    std::atomic<juce::uint64> state { 0 };
+    std::atomic<Batch*> currentBatch { nullptr };
+    std::atomic<int> unfinishedJobs { 0 };
+    
+    // Workers that have gone, or are about to go, to sleep on wakeUp
+    std::atomic<int> sleepingWorkers { 0 };
+    WakeSemaphore wakeUp;
+};
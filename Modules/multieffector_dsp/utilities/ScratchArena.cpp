@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    ScratchArena.cpp
+    Implementation of the scratch memory.
+
+  ==============================================================================
+*/
+
+template<typename SampleType>
+void ScratchArena<SampleType>::prepare(int numChannels, int maxNumSamples, int numBands)
+{
+    channelsPerSlot = (size_t) numChannels;
+    bypassSlot = numBands;
+    block = juce::dsp::AudioBlock<SampleType>(memory,
+                                              channelsPerSlot * (size_t) (numBands + 1),
+                                              (size_t) maxNumSamples);
+    block.clear();
+
+    // Lanes without a channel are only ever cleared here, so they stay silent
+    interleaved = InterleavedBlock(interleavedMemory, MultichannelEQ<SampleType>::getNumGroups(channelsPerSlot), (size_t) maxNumSamples);
+    interleaved.clear();
+}
+
+template struct ScratchArena<float>;
+template struct ScratchArena<double>;
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    ScratchArena.h
+    Preallocated working memory for processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Working memory for processBlock, allocated once in prepareToPlay.
+// The band and bypass buffers are channel ranges of a single AudioBlock, so the audio
+// thread only ever takes views into it.
+// The interleaved block holds one SIMD register per sample for each group of channels
+// that fits in a register, with a channel per lane, for the EQ.
+template<typename SampleType>
+struct ScratchArena
+{
+    using InterleavedBlock = juce::dsp::AudioBlock<juce::dsp::SIMDRegister<SampleType>>;
+
+    void prepare(int numChannels, int maxNumSamples, int numBands);
+
+    juce::dsp::AudioBlock<SampleType> getBandBlock(int bandIndex, size_t numSamples) const { return getSlot(bandIndex, numSamples); }
+
+    // A copy of the input for the bypass path, while it runs alongside the oversampled one
+    juce::dsp::AudioBlock<SampleType> getBypassBlock(size_t numSamples) const { return getSlot(bypassSlot, numSamples); }
+
+    InterleavedBlock getInterleavedBlock(size_t numSamples) const
+    {
+        jassert(numSamples <= interleaved.getNumSamples());
+        return interleaved.getSubBlock(0, numSamples);
+    }
+
+private:
+    juce::dsp::AudioBlock<SampleType> getSlot(int slot, size_t numSamples) const
+    {
+        jassert(numSamples <= block.getNumSamples());
+        return block.getSubsetChannelBlock((size_t) slot * channelsPerSlot, channelsPerSlot)
+                    .getSubBlock(0, numSamples);
+    }
+
+    juce::HeapBlock<char> memory, interleavedMemory;
+    juce::dsp::AudioBlock<SampleType> block;
+    InterleavedBlock interleaved;
+    size_t channelsPerSlot = 0;
+    int bypassSlot = 0; // after the band slots
+};
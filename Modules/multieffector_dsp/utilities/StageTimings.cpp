@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    StageTimings.cpp
+    Implementation of the per-stage timing counters.
+
+  ==============================================================================
+*/
+
+juce::String StageTimings::getStageName(int stage)
+{
+    if (stage >= firstBand && stage < recombine)
+        return "Band " + juce::String(stage - firstBand + 1);
+
+    switch (stage)
+    {
+        case total:          return "Total";
+        case bypassPath:     return "Bypass";
+        case oversampleUp:   return "OS up";
+        case eq:             return "EQ";
+        case crossoverSplit: return "Split";
+        case recombine:      return "Sum";
+        case oversampleDown: return "OS down";
+        default:             return {};
+    }
+}
+
+StageTimings::StageTimings()
+    : firstCycles(readCycleCounter()),
+      firstTicks(juce::Time::getHighResolutionTicks())
+{
+}
+
+void StageTimings::endBlock() noexcept
+{
+    for (size_t stage = 0; stage < current.size(); ++stage)
+    {
+        const auto cycles = current[stage].exchange(0, std::memory_order_relaxed);
+        totals[stage].fetch_add(cycles, std::memory_order_relaxed);
+
+        // Only this thread raises the peak and the reader only clears it, so losing a
+        // race with the reader just moves this block into the next reading
+        if (cycles > peaks[stage].load(std::memory_order_relaxed))
+            peaks[stage].store(cycles, std::memory_order_relaxed);
+    }
+
+    numBlocks.fetch_add(1, std::memory_order_release);
+}
+
+StageTimings::Reading StageTimings::read()
+{
+    Reading reading;
+
+    const auto blocks = numBlocks.load(std::memory_order_acquire);
+    reading.numBlocks = (int) (blocks - lastNumBlocks);
+    lastNumBlocks = blocks;
+
+    const auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - firstTicks);
+    const auto elapsedCycles = (double) (readCycleCounter() - firstCycles);
+    const auto microsecondsPerCycle = elapsedCycles > 0.0 ? elapsedSeconds * 1.0e6 / elapsedCycles : 0.0;
+
+    for (size_t stage = 0; stage < totals.size(); ++stage)
+    {
+        const auto stageTotal = totals[stage].load(std::memory_order_relaxed);
+        const auto cycles = stageTotal - lastTotals[stage];
+        lastTotals[stage] = stageTotal;
+
+        if (reading.numBlocks > 0)
+            reading.averageMicroseconds[stage] = (double) cycles / reading.numBlocks * microsecondsPerCycle;
+
+        reading.peakMicroseconds[stage] = (double) peaks[stage].exchange(0, std::memory_order_relaxed) * microsecondsPerCycle;
+    }
+
+    return reading;
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    StageTimings.h
+    Per-stage CPU time of processBlock, measured with the cycle counter on the
+    audio thread and read by the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Set MULTIEFFECTOR_STAGE_TIMING to 1 to time every stage of processBlock and show
+// the results over the response curve. The .jucer sets it for the debug
+// configuration. At 0 the timers, the counters and the overlay all compile away.
+#ifndef MULTIEFFECTOR_STAGE_TIMING
+ #define MULTIEFFECTOR_STAGE_TIMING 0
+#endif
+
+// The time stamp counter on x86, which ticks at a constant rate close to the nominal
+// clock. Elsewhere the high resolution clock stands in for it, so counts are still
+// comparable with each other but aren't cycles.
+inline bool hasCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+inline juce::uint64 readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::uint64) __rdtsc();
+   #else
+    return (juce::uint64) juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+// Cycles spent in each stage, summed per block by the audio thread and whichever
+// workers help it, then published into running totals and a peak that the message
+// thread reads without locking. Band stages add up every channel's distortion, so
+// with the worker pool they are CPU time rather than time on the audio thread.
+class StageTimings
+{
+public:
+    enum Stage
+    {
+        total,
+        bypassPath,
+        oversampleUp,
+        eq,
+        crossoverSplit,
+        firstBand,
+        recombine = firstBand + numBands,
+        oversampleDown,
+        numStages
+    };
+
+    static juce::String getStageName(int stage);
+
+    StageTimings();
+
+    // Audio thread, or a worker running a job for it
+    void add(int stage, juce::uint64 cycles) noexcept { current[(size_t) stage].fetch_add(cycles, std::memory_order_relaxed); }
+
+    // Audio thread: closes the block once every stage in it has finished
+    void endBlock() noexcept;
+
+    struct ScopedTimer
+    {
+        ScopedTimer(StageTimings& timingsToUse, int stageToTime) noexcept
+            : timings(timingsToUse), stage(stageToTime), start(readCycleCounter()) {}
+        ~ScopedTimer() noexcept { timings.add(stage, readCycleCounter() - start); }
+
+        StageTimings& timings;
+        const int stage;
+        const juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    // Times the whole block as the total stage, then closes it
+    struct ScopedBlock
+    {
+        explicit ScopedBlock(StageTimings& timingsToUse) noexcept : timings(timingsToUse), start(readCycleCounter()) {}
+        ~ScopedBlock() noexcept
+        {
+            timings.add(total, readCycleCounter() - start);
+            timings.endBlock();
+        }
+
+        StageTimings& timings;
+        const juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    struct Reading
+    {
+        int numBlocks = 0;
+        std::array<double, numStages> averageMicroseconds{}, peakMicroseconds{};
+    };
+
+    // Message thread: the average and the longest block of each stage since the last call
+    Reading read();
+private:
+    std::array<std::atomic<juce::uint64>, numStages> current{}, totals{}, peaks{};
+    std::atomic<juce::uint64> numBlocks { 0 };
+
+    // Reader side. Cycles are converted to microseconds by comparing the counter with
+    // the high resolution clock over the instance's lifetime.
+    std::array<juce::uint64, numStages> lastTotals{};
+    juce::uint64 lastNumBlocks = 0;
+    const juce::uint64 firstCycles;
+    const juce::int64 firstTicks;
+};
+
+// Times the rest of the enclosing scope as one stage. Both compile to nothing unless
+// MULTIEFFECTOR_STAGE_TIMING is set, so the timings object doesn't need to exist then.
+#if MULTIEFFECTOR_STAGE_TIMING
+ #define MULTIEFFECTOR_TIME_STAGE(timings, stage) const StageTimings::ScopedTimer JUCE_JOIN_MACRO(stageTimer, __LINE__) (timings, stage)
+ #define MULTIEFFECTOR_TIME_BLOCK(timings) const StageTimings::ScopedBlock JUCE_JOIN_MACRO(blockTimer, __LINE__) (timings)
+#else
+ #define MULTIEFFECTOR_TIME_STAGE(timings, stage)
+ #define MULTIEFFECTOR_TIME_BLOCK(timings)
+#endif
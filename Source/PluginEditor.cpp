@@ -99,7 +99,7 @@ void ResponseCurveComponent::updateChain()
     updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
     updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
     
-    crossoverFilters.update(chainSettings.crossoverLow, chainSettings.crossoverHigh);
+    crossoverFilters.update(chainSettings.crossovers);
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
@@ -128,8 +128,7 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     auto& lowcut = monoChain.get<ChainPositions::LowCut>();
     auto& peak = monoChain.get<ChainPositions::Peak>();
     auto& highcut = monoChain.get<ChainPositions::HighCut>();
-    auto& lowBandLine = crossoverFilters.getCutoffFrequencies()[0];
-    auto& highBandLine = crossoverFilters.getCutoffFrequencies()[1];
+    auto crossoverFrequencies = crossoverFilters.getCutoffFrequencies();
     auto sampleRate = audioProcessor.getSampleRate();
 
     std::vector<double> mags;
@@ -182,24 +181,29 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         return responseArea.getX() + normX * w;         // Scale to response area width
     };
 
-    // Draw low crossover area
-    float lowX = mapFreqToX(lowBandLine);
-    g.setColour(responseCurveLine.withAlpha(0.6f));
-    g.fillRect(Rectangle<float> (lowX, 0, 2.0f, responseArea.getBottom() * 1.1));
-    g.setColour(crossoverLeft.withAlpha(0.15f));
-    g.fillRect(Rectangle<float> (0, 0, lowX, responseArea.getBottom() * 1.1));
-    
-    
-    // Draw high crossover area
-    float highX = mapFreqToX(highBandLine);
-    g.setColour(responseCurveLine.withAlpha(0.6f));
-    g.fillRect(Rectangle<float> (highX, 0, 2.0f, responseArea.getBottom() * 1.1));
-    g.setColour(crossoverRight.withAlpha(0.15f));
-    g.fillRect(Rectangle<float> (highX, 0, getRenderArea().getWidth() - highX, responseArea.getBottom() * 1.1));
+    // Shade each band, lowest band on the left, and draw a line at each crossover
+    auto bandColour = [](int bandIndex) {
+        if (bandIndex == 0)
+            return crossoverLeft;
+        return bandIndex == numBands - 1 ? crossoverRight : crossoverMid;
+    };
     
-    // Draw mid crossover area
-    g.setColour(crossoverMid.withAlpha(0.15f));
-    g.fillRect(Rectangle<float> (0, 0, highX, responseArea.getBottom() * 1.1));
+    float bandStartX = 0;
+    for (int band = 0; band < numBands; ++band)
+    {
+        float bandEndX = band < numCrossovers ? mapFreqToX(crossoverFrequencies[(size_t) band])
+                                              : (float) getRenderArea().getWidth();
+        g.setColour(bandColour(band).withAlpha(0.15f));
+        g.fillRect(Rectangle<float> (bandStartX, 0, bandEndX - bandStartX, responseArea.getBottom() * 1.1));
+        
+        if (band < numCrossovers)
+        {
+            g.setColour(responseCurveLine.withAlpha(0.6f));
+            g.fillRect(Rectangle<float> (bandEndX, 0, 2.0f, responseArea.getBottom() * 1.1));
+        }
+        
+        bandStartX = bandEndX;
+    }
 }
 
 void ResponseCurveComponent::resized()
@@ -406,49 +410,89 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 void _3BandMultiEffectorAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 {
-    if (slider == &crossoverLowSlider)
+    // Keep the crossovers in order by pushing the ones on either side along
+    auto index = crossoverSliders.indexOf(static_cast<RotarySliderWithLabels*>(slider));
+    if (index < 0)
+        return;
+    
+    auto value = slider->getValue();
+    bool movedAnother = false;
+    
+    for (int i = 0; i < crossoverSliders.size(); ++i)
     {
-        if (crossoverLowSlider.getValue() > crossoverHighSlider.getValue()) {
-            crossoverHighSlider.setValue(crossoverLowSlider.getValue(), juce::sendNotificationSync);
-            responseCurveComponent.updateChain();
-            responseCurveComponent.repaint();
+        auto* other = crossoverSliders[i];
+        if ((i < index && other->getValue() > value) || (i > index && other->getValue() < value))
+        {
+            other->setValue(value, juce::sendNotificationSync);
+            movedAnother = true;
         }
     }
-    else if (slider == &crossoverHighSlider)
+    
+    if (movedAnother)
     {
-        if (crossoverHighSlider.getValue() < crossoverLowSlider.getValue()) {
-            crossoverLowSlider.setValue(crossoverHighSlider.getValue(), juce::sendNotificationSync);
-            responseCurveComponent.updateChain();
-            responseCurveComponent.repaint();
-        }
+        responseCurveComponent.updateChain();
+        responseCurveComponent.repaint();
     }
 }
 
 // ====================================== Combo Box ====================================== //
 
 void setDistortionComboBoxBounds(juce::Rectangle<int> bounds, int comboBoxHeight,
-                                 juce::ComboBox& lowCombo, juce::ComboBox& midCombo, juce::ComboBox& highCombo)
+                                 const juce::OwnedArray<BandControls>& bands)
 {
     bounds.setHeight(comboBoxHeight);
     bounds.setTop(bounds.getY() + 10);
 
     // Reduce the total width allocated to combo boxes
     int totalComboBoxWidth = bounds.getWidth() * 0.75f;
-    int comboBoxWidth = totalComboBoxWidth / 3;  // Divide equally for three combo boxes
-    int spacing = (bounds.getWidth() - totalComboBoxWidth) / 4;  // Distribute space
+    int comboBoxWidth = totalComboBoxWidth / bands.size();  // Divide equally between the bands
+    int spacing = (bounds.getWidth() - totalComboBoxWidth) / (bands.size() + 1);  // Distribute space
 
     // Position each combo box with spacing
-    lowCombo.setBounds(bounds.getX() + spacing, bounds.getY(), comboBoxWidth, comboBoxHeight);
-    midCombo.setBounds(lowCombo.getRight() + spacing, bounds.getY(), comboBoxWidth, comboBoxHeight);
-    highCombo.setBounds(midCombo.getRight() + spacing, bounds.getY(), comboBoxWidth, comboBoxHeight);
+    int x = bounds.getX();
+    for (auto* band : bands)
+    {
+        band->typeComboBox.setBounds(x + spacing, bounds.getY(), comboBoxWidth, comboBoxHeight);
+        x = band->typeComboBox.getRight();
+    }
+}
+
+BandControls::BandControls(juce::AudioProcessorValueTreeState& apvts, int bandIndex)
+    : driveSlider(*apvts.getParameter(getBandParameterPrefix(bandIndex) + "Drive"), ""),
+      postGainSlider(*apvts.getParameter(getBandParameterPrefix(bandIndex) + "PostGain"), "dB"),
+      mixSlider(*apvts.getParameter(getBandParameterPrefix(bandIndex) + "Mix"), "%"),
+      driveAttachment(apvts, getBandParameterPrefix(bandIndex) + "Drive", driveSlider),
+      postGainAttachment(apvts, getBandParameterPrefix(bandIndex) + "PostGain", postGainSlider),
+      mixAttachment(apvts, getBandParameterPrefix(bandIndex) + "Mix", mixSlider)
+{
+    driveSlider.labels.add({0.f, "0"});
+    driveSlider.labels.add({1.f, "50"});
+
+    postGainSlider.labels.add({0.f, "-40"});
+    postGainSlider.labels.add({1.f, "20"});
+
+    mixSlider.labels.add({0.f, "0"});
+    mixSlider.labels.add({1.f, "100"});
+
+    // Add distortion type options to the combo box before attaching it
+    typeComboBox.addItem("Soft Clipping", 1);
+    typeComboBox.addItem("Hard Clipping", 2);
+    typeComboBox.addItem("ArcTan Distortion", 3);
+    typeComboBox.addItem("Bit Crusher", 4);
+    typeComboBox.addItem("Sine Folding", 5);
+
+    typeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, getBandParameterPrefix(bandIndex) + "Type", typeComboBox);
+}
+
+BandControls::~BandControls()
+{
+    typeComboBox.setLookAndFeel(nullptr);
 }
 
 _3BandMultiEffectorAudioProcessorEditor::~_3BandMultiEffectorAudioProcessorEditor()
 {
-    lowDistortionTypeComboBox.setLookAndFeel(nullptr);
-    midDistortionTypeComboBox.setLookAndFeel(nullptr);
-    highDistortionTypeComboBox.setLookAndFeel(nullptr);
-    
+    responseCurveComponent.removeMouseListener(this);
     levelCompensationButton.setLookAndFeel(nullptr);
 }
 
@@ -463,36 +507,18 @@ _3BandMultiEffectorAudioProcessorEditor::_3BandMultiEffectorAudioProcessorEditor
       highCutFreqSlider(*audioProcessor.apvts.getParameter("High-Cut Frequency"), "Hz"),
       lowCutSlopeSlider(*audioProcessor.apvts.getParameter("Low-Cut Slope"), "dB/Oct"),
       highCutSlopeSlider(*audioProcessor.apvts.getParameter("High-Cut Slope"), "dB/Oct"),
-      crossoverLowSlider(*audioProcessor.apvts.getParameter("CrossoverLow"), "Hz"),
-      crossoverHighSlider(*audioProcessor.apvts.getParameter("CrossoverHigh"), "Hz"),
-      lowBandDriveSlider(*audioProcessor.apvts.getParameter("LowBandDrive"), ""),
-      midBandDriveSlider(*audioProcessor.apvts.getParameter("MidBandDrive"), ""),
-      highBandDriveSlider(*audioProcessor.apvts.getParameter("HighBandDrive"), ""),
-      lowBandPostGainSlider(*audioProcessor.apvts.getParameter("LowBandPostGain"), "dB"),
-      midBandPostGainSlider(*audioProcessor.apvts.getParameter("MidBandPostGain"), "dB"),
-      highBandPostGainSlider(*audioProcessor.apvts.getParameter("HighBandPostGain"), "dB"),
-      lowBandMixSlider(*audioProcessor.apvts.getParameter("LowBandMix"), "%"),
-      midBandMixSlider(*audioProcessor.apvts.getParameter("MidBandMix"), "%"),
-      highBandMixSlider(*audioProcessor.apvts.getParameter("HighBandMix"), "%"),
       responseCurveComponent(audioProcessor),
+     #if MULTIEFFECTOR_STAGE_TIMING
+      stageTimingOverlay(audioProcessor.stageTimings),
+     #endif
+      deadlineHistogram(audioProcessor.deadlineMonitor),
       peakFreqSliderAttachment(audioProcessor.apvts, "Peak Frequency", peakFreqSlider),
       peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
       peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
       lowCutFreqSliderAttachment(audioProcessor.apvts, "Low-Cut Frequency", lowCutFreqSlider),
       highCutFreqSliderAttachment(audioProcessor.apvts, "High-Cut Frequency", highCutFreqSlider),
       lowCutSlopeSliderAttachment(audioProcessor.apvts, "Low-Cut Slope", lowCutSlopeSlider),
-      highCutSlopeSliderAttachment(audioProcessor.apvts, "High-Cut Slope", highCutSlopeSlider),
-      crossoverLowSliderAttachment(audioProcessor.apvts, "CrossoverLow", crossoverLowSlider),
-      crossoverHighSliderAttachment(audioProcessor.apvts, "CrossoverHigh", crossoverHighSlider),
-      lowBandDriveSliderAttachment(audioProcessor.apvts, "LowBandDrive", lowBandDriveSlider),
-      midBandDriveSliderAttachment(audioProcessor.apvts, "MidBandDrive", midBandDriveSlider),
-      highBandDriveSliderAttachment(audioProcessor.apvts, "HighBandDrive", highBandDriveSlider),
-      lowBandPostGainSliderAttachment(audioProcessor.apvts, "LowBandPostGain", lowBandPostGainSlider),
-      midBandPostGainSliderAttachment(audioProcessor.apvts, "MidBandPostGain", midBandPostGainSlider),
-      highBandPostGainSliderAttachment(audioProcessor.apvts, "HighBandPostGain", highBandPostGainSlider),
-      lowBandMixSliderAttachment(audioProcessor.apvts, "LowBandMix", lowBandMixSlider),
-      midBandMixSliderAttachment(audioProcessor.apvts, "MidBandMix", midBandMixSlider),
-      highBandMixSliderAttachment(audioProcessor.apvts, "HighBandMix", highBandMixSlider)
+      highCutSlopeSliderAttachment(audioProcessor.apvts, "High-Cut Slope", highCutSlopeSlider)
 {
     // Labels for Peak Frequency Slider
     peakFreqSlider.labels.add({0.f, "20"});
@@ -522,68 +548,25 @@ _3BandMultiEffectorAudioProcessorEditor::_3BandMultiEffectorAudioProcessorEditor
     highCutSlopeSlider.labels.add({0.f, "12"});
     highCutSlopeSlider.labels.add({1.f, "48"});
 
-    // Labels for Crossover Low Slider
-    crossoverLowSlider.labels.add({0.f, "20"});
-    crossoverLowSlider.labels.add({1.f, "5k"});
-
-    // Labels for Crossover High Slider
-    crossoverHighSlider.labels.add({0.f, "5k"});
-    crossoverHighSlider.labels.add({1.f, "20k"});
-
-    // Labels for Low Band Drive Slider
-    lowBandDriveSlider.labels.add({0.f, "0"});
-    lowBandDriveSlider.labels.add({1.f, "50"});
-
-    // Labels for Mid Band Drive Slider
-    midBandDriveSlider.labels.add({0.f, "0"});
-    midBandDriveSlider.labels.add({1.f, "50"});
-
-    // Labels for High Band Drive Slider
-    highBandDriveSlider.labels.add({0.f, "0"});
-    highBandDriveSlider.labels.add({1.f, "50"});
-
-    // Labels for Low Band Post-Gain Slider
-    lowBandPostGainSlider.labels.add({0.f, "-40"});
-    lowBandPostGainSlider.labels.add({1.f, "20"});
-
-    // Labels for Mid Band Post-Gain Slider
-    midBandPostGainSlider.labels.add({0.f, "-40"});
-    midBandPostGainSlider.labels.add({1.f, "20"});
-
-    // Labels for High Band Post-Gain Slider
-    highBandPostGainSlider.labels.add({0.f, "-40"});
-    highBandPostGainSlider.labels.add({1.f, "20"});
-
-    // Labels for Low Band Mix Slider
-    lowBandMixSlider.labels.add({0.f, "0"});
-    lowBandMixSlider.labels.add({1.f, "100"});
-
-    // Labels for Mid Band Mix Slider
-    midBandMixSlider.labels.add({0.f, "0"});
-    midBandMixSlider.labels.add({1.f, "100"});
-
-    // Labels for High Band Mix Slider
-    highBandMixSlider.labels.add({0.f, "0"});
-    highBandMixSlider.labels.add({1.f, "100"});
-
-    // Add distortion type options to combo boxes
-    lowDistortionTypeComboBox.addItem("Soft Clipping", 1);
-    lowDistortionTypeComboBox.addItem("Hard Clipping", 2);
-    lowDistortionTypeComboBox.addItem("ArcTan Distortion", 3);
-    lowDistortionTypeComboBox.addItem("Bit Crusher", 4);
-    lowDistortionTypeComboBox.addItem("Sine Folding", 5);
-    
-    midDistortionTypeComboBox.addItem("Soft Clipping", 1);
-    midDistortionTypeComboBox.addItem("Hard Clipping", 2);
-    midDistortionTypeComboBox.addItem("ArcTan Distortion", 3);
-    midDistortionTypeComboBox.addItem("Bit Crusher", 4);
-    midDistortionTypeComboBox.addItem("Sine Folding", 5);
-
-    highDistortionTypeComboBox.addItem("Soft Clipping", 1);
-    highDistortionTypeComboBox.addItem("Hard Clipping", 2);
-    highDistortionTypeComboBox.addItem("ArcTan Distortion", 3);
-    highDistortionTypeComboBox.addItem("Bit Crusher", 4);
-    highDistortionTypeComboBox.addItem("Sine Folding", 5);
+    // Crossover sliders, with the original low/high labels in the 3 band layout
+    for (int i = 0; i < numCrossovers; ++i)
+    {
+        auto parameterID = getCrossoverParameterID(i);
+        auto* slider = crossoverSliders.add(new RotarySliderWithLabels(*audioProcessor.apvts.getParameter(parameterID), "Hz"));
+        crossoverSliderAttachments.add(new Attachment(audioProcessor.apvts, parameterID, *slider));
+        
+        bool isUpperCrossover = numBands == 3 && i == 1;
+        slider->labels.add({0.f, isUpperCrossover ? "5k" : "20"});
+        slider->labels.add({1.f, isUpperCrossover || numBands != 3 ? "20k" : "5k"});
+        slider->addListener(this);
+    }
+
+    // Type, drive, post-gain and mix controls for each band
+    for (int i = 0; i < numBands; ++i)
+    {
+        auto* band = bandControls.add(new BandControls(audioProcessor.apvts, i));
+        band->typeComboBox.setLookAndFeel(&customLookAndFeelComboBox);
+    }
 
     levelCompensationButton.setClickingTogglesState(true); // Enable toggle behavior
         levelCompensationButton.setButtonText("ON"); // Initial text
@@ -602,22 +585,6 @@ _3BandMultiEffectorAudioProcessorEditor::_3BandMultiEffectorAudioProcessorEditor
     levelCompensationButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
             audioProcessor.apvts, "LevelCompensation", levelCompensationButton);
     
-    // Set custom look and feel for combo boxes
-    lowDistortionTypeComboBox.setLookAndFeel(&customLookAndFeelComboBox);
-    midDistortionTypeComboBox.setLookAndFeel(&customLookAndFeelComboBox);
-    highDistortionTypeComboBox.setLookAndFeel(&customLookAndFeelComboBox);
-    
-    // Create ComboBoxAttachments to bind combo boxes to parameters
-    lowDistortionTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
-        audioProcessor.apvts, "LowBandType", lowDistortionTypeComboBox);
-    midDistortionTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
-        audioProcessor.apvts, "MidBandType", midDistortionTypeComboBox);
-    highDistortionTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
-        audioProcessor.apvts, "HighBandType", highDistortionTypeComboBox);
-    
-    crossoverLowSlider.addListener(this);
-    crossoverHighSlider.addListener(this);
-
     // Add all components to the editor
     for (auto* comp : getComps())
     {
@@ -625,9 +592,16 @@ _3BandMultiEffectorAudioProcessorEditor::_3BandMultiEffectorAudioProcessorEditor
     }
     
     addAndMakeVisible(crossoverDivider);
+    
+   #if MULTIEFFECTOR_STAGE_TIMING
+    addAndMakeVisible(stageTimingOverlay); // after the response curve, so it's drawn on top
+   #endif
+    
+    addChildComponent(deadlineHistogram);
+    responseCurveComponent.addMouseListener(this, false);
 
-    // Set the editor's size
-    setSize(500, 850);
+    // Set the editor's size, widening it past three bands so the columns keep their size
+    setSize(juce::jmax(500, numBands * 500 / 3), 850);
 }
 
 void _3BandMultiEffectorAudioProcessorEditor::paint(juce::Graphics& g)
@@ -643,10 +617,9 @@ void _3BandMultiEffectorAudioProcessorEditor::paint(juce::Graphics& g)
     buttonPath.addRoundedRectangle(buttonBounds, cornerRadius);
     shadow.drawForPath(g, buttonPath);
     
-    for (auto* comp : {&lowDistortionTypeComboBox,
-                      &midDistortionTypeComboBox, &highDistortionTypeComboBox})
+    for (auto* band : bandControls)
     {
-        auto bounds = comp->getBounds().toFloat();
+        auto bounds = band->typeComboBox.getBounds().toFloat();
         Path path;
         path.addRoundedRectangle(bounds, cornerRadius);
         shadow.drawForPath(g, path);
@@ -664,6 +637,12 @@ void _3BandMultiEffectorAudioProcessorEditor::resized()
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
     responseCurveComponent.setBounds(responseArea);
     
+   #if MULTIEFFECTOR_STAGE_TIMING
+    stageTimingOverlay.setBounds(responseArea.getX() + 6, responseArea.getY() + 6, 260,
+                                 stageTimingOverlay.getNumRows() * stageTimingOverlay.getRowHeight() + 6);
+   #endif
+    deadlineHistogram.setBounds(responseArea.reduced(6).removeFromRight(320));
+    
     // Reserve some space at the bottom for new sliders
     const int bottomMargin = bounds.getHeight() * 0.65;
     bounds.removeFromBottom(bottomMargin);
@@ -696,10 +675,24 @@ void _3BandMultiEffectorAudioProcessorEditor::resized()
     crossoverArea.setTop(bounds.getBottom() + gap / 2);
     
     crossoverArea.setHeight(bounds.getHeight() * 1.3);
-    crossoverLowSlider.setBounds(crossoverArea.removeFromLeft(crossoverArea.getWidth() * 0.33));
     
-    auto buttonLabelArea = crossoverArea.removeFromLeft(crossoverArea.getWidth() * 0.5);
-    buttonLabelArea.setTop(crossoverArea.getCentreY() - 30);
+    // One column per crossover, with the level compensation button in the middle column
+    const int numCrossoverColumns = numCrossovers + 1;
+    const int buttonColumn = numCrossovers / 2;
+    const int crossoverColumnWidth = crossoverArea.getWidth() / numCrossoverColumns;
+    
+    juce::Rectangle<int> buttonLabelArea;
+    for (int column = 0, slider = 0; column < numCrossoverColumns; ++column)
+    {
+        auto columnArea = column == numCrossoverColumns - 1 ? crossoverArea
+                                                            : crossoverArea.removeFromLeft(crossoverColumnWidth);
+        if (column == buttonColumn)
+            buttonLabelArea = columnArea;
+        else
+            crossoverSliders[slider++]->setBounds(columnArea);
+    }
+    
+    buttonLabelArea.setTop(buttonLabelArea.getCentreY() - 30);
     buttonLabelArea.setHeight(30);
     buttonLabelArea.setLeft(buttonLabelArea.getCentreX() - 75);
     buttonLabelArea.setWidth(150);
@@ -712,8 +705,6 @@ void _3BandMultiEffectorAudioProcessorEditor::resized()
     buttonArea.setWidth(40);
     levelCompensationButton.setBounds(buttonArea);
     
-    crossoverHighSlider.setBounds(crossoverArea);
-    
     // Define height for the ComboBox
     int comboBoxHeight = 25;
 
@@ -722,40 +713,71 @@ void _3BandMultiEffectorAudioProcessorEditor::resized()
     distortionBounds.setTop(crossoverArea.getBottom() + 10);
     distortionBounds.setHeight(comboBoxHeight);
 
-    setDistortionComboBoxBounds(distortionBounds, comboBoxHeight,
-                                 lowDistortionTypeComboBox, midDistortionTypeComboBox, highDistortionTypeComboBox);
+    setDistortionComboBoxBounds(distortionBounds, comboBoxHeight, bandControls);
     
     // Layout the band controls
     auto bandArea = getLocalBounds();
     bandArea.setTop(distortionBounds.getBottom() + 10);
     bandArea.setBottom(getLocalBounds().getBottom() - 20);
 
-    auto bandWidth = bandArea.getWidth() / 3;
-    auto lowBandArea = bandArea.removeFromLeft(bandWidth);
-    auto midBandArea = bandArea.removeFromLeft(bandWidth);
-    auto highBandArea = bandArea; // Remaining space for high band
+    auto bandWidth = bandArea.getWidth() / numBands;
     
     // Determine equal height for each slider within the band area
     int numSliders = 3; // Drive, Post-Gain, Mix
-    int sliderHeight = lowBandArea.getHeight() / numSliders;
+    int sliderHeight = bandArea.getHeight() / numSliders;
 
-    // Assign sliders evenly within their respective areas
-    lowBandDriveSlider.setBounds(lowBandArea.removeFromTop(sliderHeight));
-    midBandDriveSlider.setBounds(midBandArea.removeFromTop(sliderHeight));
-    highBandDriveSlider.setBounds(highBandArea.removeFromTop(sliderHeight));
+    // Assign sliders evenly within each band's column, the last one taking what's left
+    for (auto* band : bandControls)
+    {
+        auto columnArea = band == bandControls.getLast() ? bandArea : bandArea.removeFromLeft(bandWidth);
+        band->driveSlider.setBounds(columnArea.removeFromTop(sliderHeight));
+        band->postGainSlider.setBounds(columnArea.removeFromTop(sliderHeight));
+        band->mixSlider.setBounds(columnArea);
+    }
+}
 
-    lowBandPostGainSlider.setBounds(lowBandArea.removeFromTop(sliderHeight));
-    midBandPostGainSlider.setBounds(midBandArea.removeFromTop(sliderHeight));
-    highBandPostGainSlider.setBounds(highBandArea.removeFromTop(sliderHeight));
+void _3BandMultiEffectorAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
+{
+    if (event.eventComponent == &responseCurveComponent && event.mods.isPopupMenu())
+        showDebugMenu();
+}
 
-    lowBandMixSlider.setBounds(lowBandArea);
-    midBandMixSlider.setBounds(midBandArea);
-    highBandMixSlider.setBounds(highBandArea);
+void _3BandMultiEffectorAudioProcessorEditor::showDebugMenu()
+{
+    juce::PopupMenu menu;
+    menu.setLookAndFeel(&customLookAndFeelComboBox);
+    
+    menu.addItem("Show Deadline Histogram", true, deadlineHistogram.isVisible(), [this] {
+        deadlineHistogram.setVisible(! deadlineHistogram.isVisible());
+    });
+    menu.addItem("Save Deadline Histogram...", [this] { saveDeadlineHistogram(); });
+    menu.addItem("Reset Deadline Histogram", [this] { audioProcessor.deadlineMonitor.reset(); });
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withMousePosition());
+}
+
+void _3BandMultiEffectorAudioProcessorEditor::saveDeadlineHistogram()
+{
+    // What was counted up to the click, not up to when the chooser closes
+    const auto report = audioProcessor.deadlineMonitor.getSnapshot().toText();
+    
+    deadlineFileChooser = std::make_unique<juce::FileChooser>("Save Deadline Histogram",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("3BandMultiEffector Deadlines.txt"),
+        "*.txt");
+    
+    const auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                     | juce::FileBrowserComponent::warnAboutOverwriting;
+    
+    deadlineFileChooser->launchAsync(flags, [report](const juce::FileChooser& chooser) {
+        auto file = chooser.getResult();
+        if (file != juce::File())
+            file.replaceWithText(report);
+    });
 }
 
 std::vector<juce::Component*> _3BandMultiEffectorAudioProcessorEditor::getComps()
 {
-    return
+    std::vector<juce::Component*> comps
     {
         &peakFreqSlider,
         &peakGainSlider,
@@ -763,22 +785,148 @@ std::vector<juce::Component*> _3BandMultiEffectorAudioProcessorEditor::getComps(
         &lowCutFreqSlider,
         &highCutFreqSlider,
         &lowCutSlopeSlider,
-        &highCutSlopeSlider,
-        &crossoverLowSlider,
-        &crossoverHighSlider,
-        &lowBandDriveSlider,
-        &midBandDriveSlider,
-        &highBandDriveSlider,
-        &lowBandPostGainSlider,
-        &midBandPostGainSlider,
-        &highBandPostGainSlider,
-        &lowBandMixSlider,
-        &midBandMixSlider,
-        &highBandMixSlider,
-        &lowDistortionTypeComboBox,
-        &midDistortionTypeComboBox,
-        &highDistortionTypeComboBox,
-        &responseCurveComponent,
-        &levelCompensationButton
+        &highCutSlopeSlider
     };
+    
+    for (auto* slider : crossoverSliders)
+        comps.push_back(slider);
+    
+    for (auto* band : bandControls)
+    {
+        comps.push_back(&band->driveSlider);
+        comps.push_back(&band->postGainSlider);
+        comps.push_back(&band->mixSlider);
+    }
+    
+    for (auto* band : bandControls)
+        comps.push_back(&band->typeComboBox);
+    
+    comps.push_back(&responseCurveComponent);
+    comps.push_back(&levelCompensationButton);
+    return comps;
+}
+
+// ====================================== Deadline Histogram ====================================== //
+
+DeadlineHistogramComponent::DeadlineHistogramComponent(DeadlineMonitor& monitorToRead) : monitor(monitorToRead)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void DeadlineHistogramComponent::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz(10);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void DeadlineHistogramComponent::timerCallback()
+{
+    snapshot = monitor.getSnapshot();
+    repaint();
+}
+
+void DeadlineHistogramComponent::paint(juce::Graphics& g)
+{
+    g.setColour(generalBG.withAlpha(0.85f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 3.0f);
+    
+    auto area = getLocalBounds().reduced(4, 3);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 10.0f, juce::Font::plain));
+    g.setColour(parameterNameText);
+    g.drawText("blocks " + juce::String((juce::int64) snapshot.numBlocks)
+               + "  >50% " + juce::String((juce::int64) snapshot.overHalf)
+               + "  >80% " + juce::String((juce::int64) snapshot.over80Percent)
+               + "  missed " + juce::String((juce::int64) snapshot.overruns)
+               + "  worst " + juce::String(snapshot.worstFraction * 100.0f, 1) + "%",
+               area.removeFromTop(12), juce::Justification::centredLeft);
+    
+    const auto bars = area.reduced(0, 2).toFloat();
+    const auto barWidth = bars.getWidth() / DeadlineMonitor::numBins;
+    
+    // Bar heights are logarithmic too, so a handful of late blocks still shows up next
+    // to millions of quick ones
+    const auto largestCount = *std::max_element(snapshot.counts.begin(), snapshot.counts.end());
+    const auto scale = largestCount > 0 ? 1.0f / std::log1p((float) largestCount) : 0.0f;
+    
+    for (int bin = 0; bin < DeadlineMonitor::numBins; ++bin)
+    {
+        const auto height = bars.getHeight() * std::log1p((float) snapshot.counts[(size_t) bin]) * scale;
+        g.setColour(DeadlineMonitor::getBinStart(bin) >= 1.0 ? fftLeft : parameterValueText);
+        g.fillRect(bars.getX() + bin * barWidth, bars.getBottom() - height, juce::jmax(1.0f, barWidth - 1.0f), height);
+    }
+    
+    // Where 50%, 80% and 100% of the deadline fall on the bins
+    for (auto fraction : { 0.5, 0.8, 1.0 })
+    {
+        const auto position = 1.0 + (std::log2(fraction) - DeadlineMonitor::lowestOctave) * DeadlineMonitor::binsPerOctave;
+        const auto x = bars.getX() + (float) position * barWidth;
+        g.setColour(knobPointer.withAlpha(fraction >= 1.0 ? 0.9f : 0.4f));
+        g.drawVerticalLine(juce::roundToInt(x), bars.getY(), bars.getBottom());
+    }
+}
+
+// ====================================== Stage Timing Overlay ====================================== //
+
+#if MULTIEFFECTOR_STAGE_TIMING
+StageTimingOverlay::StageTimingOverlay(StageTimings& timingsToRead) : timings(timingsToRead)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(refreshRateHz);
+}
+
+void StageTimingOverlay::timerCallback()
+{
+    const auto reading = timings.read();
+    
+    // Keep the last averages while the host isn't calling processBlock
+    if (reading.numBlocks > 0)
+        averages = reading.averageMicroseconds;
+    
+    recentPeaks[nextPeakSlot] = reading.peakMicroseconds;
+    nextPeakSlot = (nextPeakSlot + 1) % recentPeaks.size();
+    
+    peaks.fill(0.0);
+    for (const auto& slot : recentPeaks)
+        for (size_t stage = 0; stage < peaks.size(); ++stage)
+            peaks[stage] = juce::jmax(peaks[stage], slot[stage]);
+    
+    repaint();
+}
+
+void StageTimingOverlay::paint(juce::Graphics& g)
+{
+    g.setColour(generalBG.withAlpha(0.8f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 3.0f);
+    
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 10.0f, juce::Font::plain));
+    
+    auto area = getLocalBounds().reduced(4, 3);
+    const auto rowHeight = getRowHeight();
+    const auto columnWidth = area.getWidth() / 2;
+    
+    g.setColour(parameterNameText);
+    g.drawText(juce::CharPointer_UTF8("\xc2\xb5s per block, average / peak"), area.removeFromTop(rowHeight),
+               juce::Justification::centredLeft);
+    
+    g.setColour(parameterValueText);
+    const auto numRowsPerColumn = getNumRows() - 1;
+    
+    for (int stage = 0; stage < StageTimings::numStages; ++stage)
+    {
+        const auto column = stage / numRowsPerColumn;
+        const auto row = stage % numRowsPerColumn;
+        juce::Rectangle<int> cell(area.getX() + column * columnWidth, area.getY() + row * rowHeight, columnWidth - 4, rowHeight);
+        
+        g.drawText(StageTimings::getStageName(stage), cell, juce::Justification::centredLeft);
+        g.drawText(juce::String(averages[(size_t) stage], 1) + " / " + juce::String(peaks[(size_t) stage], 1),
+                   cell, juce::Justification::centredRight);
+    }
 }
+#endif
@@ -226,7 +226,7 @@ private:
     _3BandMultiEffectorAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{false};
     MonoChain monoChain;
-    CrossoverFilters crossoverFilters;
+    CrossoverFilters<float> crossoverFilters;
     juce::Image background;
     juce::Rectangle<int> getRenderArea();
     
@@ -313,6 +313,22 @@ private:
     juce::String suffix;
 };
 
+// ====================================== Band Controls ====================================== //
+
+// The distortion type, drive, post gain and mix controls for one band, attached to
+// that band's parameters. The editor makes one of these per band.
+struct BandControls
+{
+    BandControls(juce::AudioProcessorValueTreeState& apvts, int bandIndex);
+    ~BandControls();
+    
+    juce::ComboBox typeComboBox;
+    RotarySliderWithLabels driveSlider, postGainSlider, mixSlider;
+    
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> typeAttachment;
+    juce::AudioProcessorValueTreeState::SliderAttachment driveAttachment, postGainAttachment, mixAttachment;
+};
+
 // ====================================== Section Divider ====================================== //
 
 class DividerComponent : public juce::Component
@@ -330,6 +346,48 @@ public:
     }
 };
 
+// ====================================== Deadline Histogram ====================================== //
+
+// The processor's DeadlineMonitor as one bar per bin, on the same log scale of the
+// deadline, under a line with the near-miss counts. Shown over the response curve
+// from the debug menu, and only reads the monitor while it's visible.
+struct DeadlineHistogramComponent : juce::Component, juce::Timer
+{
+    explicit DeadlineHistogramComponent(DeadlineMonitor& monitorToRead);
+    
+    void visibilityChanged() override;
+    void timerCallback() override;
+    void paint(juce::Graphics& g) override;
+private:
+    DeadlineMonitor& monitor;
+    DeadlineMonitor::Snapshot snapshot;
+};
+
+// ====================================== Stage Timing Overlay ====================================== //
+
+#if MULTIEFFECTOR_STAGE_TIMING
+// Average and peak microseconds per block of each processBlock stage, drawn over the
+// top left of the response curve. The peak is the longest block of the last two
+// seconds. Only built when MULTIEFFECTOR_STAGE_TIMING is set.
+struct StageTimingOverlay : juce::Component, juce::Timer
+{
+    explicit StageTimingOverlay(StageTimings& timingsToRead);
+    
+    void timerCallback() override;
+    void paint(juce::Graphics& g) override;
+    
+    static constexpr int refreshRateHz = 5;
+    int getRowHeight() const { return 11; }
+    int getNumRows() const { return (StageTimings::numStages + 1) / 2 + 1; } // two columns under a header
+private:
+    StageTimings& timings;
+    std::array<double, StageTimings::numStages> averages{}, peaks{};
+    
+    std::array<std::array<double, StageTimings::numStages>, refreshRateHz * 2> recentPeaks{};
+    size_t nextPeakSlot = 0;
+};
+#endif
+
 // ====================================== Main Editor Class ====================================== //
 
 class _3BandMultiEffectorAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Slider::Listener
@@ -341,46 +399,44 @@ public:
     void paint (juce::Graphics&) override;
     void sliderValueChanged(juce::Slider* slider) override;
     void resized() override;
+    // Right-clicking the response curve opens the debug menu
+    void mouseDown(const juce::MouseEvent& event) override;
     
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     _3BandMultiEffectorAudioProcessor& audioProcessor;
     
-    juce::ComboBox lowDistortionTypeComboBox;
-    juce::ComboBox midDistortionTypeComboBox;
-    juce::ComboBox highDistortionTypeComboBox;
-    
     CustomLookAndFeelComboBox customLookAndFeelComboBox;
     
     CustomLookAndFeelButton customLookAndFeelButton;
     
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lowDistortionTypeAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> midDistortionTypeAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> highDistortionTypeAttachment;
-    
     RotarySliderWithLabels peakFreqSlider,
                         peakGainSlider,
                         peakQualitySlider,
                         lowCutFreqSlider,
                         highCutFreqSlider,
                         lowCutSlopeSlider,
-                        highCutSlopeSlider,
-                        crossoverLowSlider,
-                        crossoverHighSlider,
-                        lowBandDriveSlider,
-                        midBandDriveSlider,
-                        highBandDriveSlider,
-                        lowBandPostGainSlider,
-                        midBandPostGainSlider,
-                        highBandPostGainSlider,
-                        lowBandMixSlider,
-                        midBandMixSlider,
-                        highBandMixSlider;
+                        highCutSlopeSlider;
+    
+    // One slider per crossover, lowest first, and one set of controls per band
+    juce::OwnedArray<RotarySliderWithLabels> crossoverSliders;
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::SliderAttachment> crossoverSliderAttachments;
+    juce::OwnedArray<BandControls> bandControls;
     
     ResponseCurveComponent responseCurveComponent;
     DividerComponent crossoverDivider;
     
+   #if MULTIEFFECTOR_STAGE_TIMING
+    StageTimingOverlay stageTimingOverlay;
+   #endif
+    
+    DeadlineHistogramComponent deadlineHistogram;
+    std::unique_ptr<juce::FileChooser> deadlineFileChooser; // kept alive while it's open
+    
+    void showDebugMenu();
+    void saveDeadlineHistogram();
+    
     juce::Label levelCompensationLabel;
     juce::TextButton levelCompensationButton;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> levelCompensationButtonAttachment;
@@ -395,18 +451,7 @@ private:
                 lowCutFreqSliderAttachment,
                 highCutFreqSliderAttachment,
                 lowCutSlopeSliderAttachment,
-                highCutSlopeSliderAttachment,
-                crossoverLowSliderAttachment,
-                crossoverHighSliderAttachment,
-                lowBandDriveSliderAttachment,
-                midBandDriveSliderAttachment,
-                highBandDriveSliderAttachment,
-                lowBandPostGainSliderAttachment,
-                midBandPostGainSliderAttachment,
-                highBandPostGainSliderAttachment,
-                lowBandMixSliderAttachment,
-                midBandMixSliderAttachment,
-                highBandMixSliderAttachment;
+                highCutSlopeSliderAttachment;
     
     std::vector<juce::Component*> getComps();
     
@@ -11,6 +11,19 @@
 #include "PluginEditor.h"
 #include <math.h>
 
+template<typename SampleType>
+static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel), buffer.getNumSamples());
+        if (range.getStart() < -silenceThreshold || range.getEnd() > silenceThreshold)
+            return false;
+    }
+
+    return true;
+}
+
 //==============================================================================
 _3BandMultiEffectorAudioProcessor::_3BandMultiEffectorAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -24,10 +37,20 @@ _3BandMultiEffectorAudioProcessor::_3BandMultiEffectorAudioProcessor()
                        )
 #endif
 {
+    // Each signal path adds its own designers
+    designThread->addTimeSliceClient(&linearPhaseCrossover);
+    designThread->addTimeSliceClient(&workerPoolSizer);
+    
+   #if MULTIEFFECTOR_STAGE_TIMING
+    floatPath.bandJobs.timings = &stageTimings;
+    doublePath.bandJobs.timings = &stageTimings;
+   #endif
 }
 
 _3BandMultiEffectorAudioProcessor::~_3BandMultiEffectorAudioProcessor()
 {
+    designThread->removeTimeSliceClient(&workerPoolSizer);
+    designThread->removeTimeSliceClient(&linearPhaseCrossover);
 }
 
 //==============================================================================
@@ -65,7 +88,7 @@ bool _3BandMultiEffectorAudioProcessor::isMidiEffect() const
 
 double _3BandMultiEffectorAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int _3BandMultiEffectorAudioProcessor::getNumPrograms()
@@ -95,47 +118,100 @@ void _3BandMultiEffectorAudioProcessor::changeProgramName (int index, const juce
 //==============================================================================
 void _3BandMultiEffectorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    // The host picks the precision before preparing, and only that path is ever used
+    if (isUsingDoublePrecision())
+        prepareSignalPath(doublePath, sampleRate, samplesPerBlock);
+    else
+        prepareSignalPath(floatPath, sampleRate, samplesPerBlock);
+
+    deadlineMonitor.prepare(sampleRate);
+}
+
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::prepareSignalPath(SignalPath<SampleType>& path, double sampleRate, int samplesPerBlock)
+{
+    const auto numChannels = getNumProcessedChannels();
+
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1; // Mono processing for each chain
+    spec.numChannels = (juce::uint32) numChannels;
     spec.sampleRate = sampleRate;
 
-    // Initialize oversampler
-    oversampler.initProcessing(samplesPerBlock);
-    auto oversampledSampleRate = sampleRate * oversampler.getOversamplingFactor();
+    const auto initialSettings = parameterSnapshot.load();
+    controlBlocks.prepare(sampleRate, samplesPerBlock, initialSettings);
+
+    // Build the first oversampler here. Everything after it that allocates is sized for
+    // the largest factor, so changing the factor later only has to retune it.
+    path.oversampling = &path.oversamplingDesigner.prepare(getOversamplingSetup(initialSettings), numChannels, samplesPerBlock);
+    auto oversampledSampleRate = getOversampledRate(path);
+    const auto maxFactor = 1 << OversamplingSetup::maxOrder;
     
     // Prepare spec for oversampled rate
     juce::dsp::ProcessSpec oversampledSpec = spec;
     oversampledSpec.sampleRate = oversampledSampleRate;
-    oversampledSpec.maximumBlockSize = samplesPerBlock * oversampler.getOversamplingFactor();
+    oversampledSpec.maximumBlockSize = (juce::uint32) (samplesPerBlock * maxFactor);
 
     // Prepare chains with oversampled spec
-    leftChain.prepare(oversampledSpec);
-    rightChain.prepare(oversampledSpec);
-
-    // Prepare crossovers
-    leftCrossover.prepare(oversampledSpec);
-    rightCrossover.prepare(oversampledSpec);
-
-    // Prepare distortion bands
-    for (auto& band : leftBands) band.prepare(oversampledSpec);
-    for (auto& band : rightBands) band.prepare(oversampledSpec);
-
-    // Prepare temp buffers for oversampled block size
-    for (auto& buf : tempBuffers)
-        buf.setSize(2, samplesPerBlock * oversampler.getOversamplingFactor());
+    path.eqChain.prepare(oversampledSpec);
+
+    // Prepare the crossover, which keeps a state per channel
+    path.crossover.prepare(oversampledSpec);
+    linearPhaseCrossover.prepare(oversampledSpec, initialSettings.crossovers, sampleRate * maxFactor);
+    activeCrossoverMode = initialSettings.crossoverMode;
+
+    // Prepare a set of distortion bands for every channel, each one mono
+    auto bandSpec = oversampledSpec;
+    bandSpec.numChannels = 1;
+    path.channelBands.resize((size_t) numChannels);
+    for (auto& bands : path.channelBands)
+        for (auto& band : bands)
+            band.prepare(bandSpec);
+
+    // One job per channel of each band. The audio thread runs jobs too, so there is no
+    // point in more workers than the other jobs, or the other cores. None are started
+    // unless Parallel Bands is on.
+    path.bandJobs.jobs.reserve((size_t) (numChannels * numBands));
+    workerPoolSizer.maxWorkers = juce::jmin(numChannels * numBands, juce::SystemStats::getNumCpus()) - 1;
+    workerPoolSizer.update();
+
+    // Size the scratch memory for the oversampled block, one buffer of every channel per band
+    path.scratchArena.prepare(numChannels, samplesPerBlock * maxFactor, numBands);
 
     // Prepare FIFO buffers with original sample rate
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
 
-    updateFilters();
+    // Design the initial coefficients here so the first block is already filtered
+    const auto& coefficients = path.coefficientDesigner.prepare(initialSettings, oversampledSampleRate);
+    coefficients.applyTo(path.eqChain);
+    appliedEqSampleRate = oversampledSampleRate;
+    eqTailSeconds = coefficients.tailSeconds;
+
+    // The bypass path runs at the host rate, but has to be able to delay the signal as
+    // much as the oversampled path does
+    path.bypassPath.prepare(spec, juce::roundToInt(sampleRate * 0.1));
+    path.bypassCoefficientDesigner.prepare(initialSettings, sampleRate).applyTo(path.bypassPath.eqChain);
+
+    audiblePath = hasNonlinearBand(initialSettings) ? ProcessingPath::Oversampled : ProcessingPath::Bypass;
+    oversampledPathRunning = audiblePath == ProcessingPath::Oversampled;
+    bypassPathRunning = audiblePath == ProcessingPath::Bypass;
+    warmedUpSamples = 0;
+    oversampledPathGain.reset(sampleRate, pathCrossfadeSeconds);
+    oversampledPathGain.setCurrentAndTargetValue(audiblePath == ProcessingPath::Oversampled ? 1.0f : 0.0f);
+
+    sleeping = false;
+    silentInputSamples = 0;
+    waitingForDesigns = false;
+    updateLatency(path);
+    updateTailLength(path, initialSettings);
 }
 
 void _3BandMultiEffectorAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    workerPoolSizer.maxWorkers = 0;
+    workerPoolSizer.update();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -145,12 +221,9 @@ bool _3BandMultiEffectorAudioProcessor::isBusesLayoutSupported (const BusesLayou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel gets its own filter and distortion state, so any main bus works,
+    // from mono up to surround layouts
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -166,7 +239,22 @@ bool _3BandMultiEffectorAudioProcessor::isBusesLayoutSupported (const BusesLayou
 
 void _3BandMultiEffectorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processSamples(floatPath, buffer);
+}
+
+void _3BandMultiEffectorAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(doublePath, buffer);
+}
+
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::processSamples(SignalPath<SampleType>& path, juce::AudioBuffer<SampleType>& buffer)
+{
+    // Offline renders have no deadline, so they aren't recorded
+    const DeadlineMonitor::ScopedBlock deadlineCheck(deadlineMonitor, isNonRealtime() ? 0 : buffer.getNumSamples());
     juce::ScopedNoDenormals noDenormals;
+    ScopedAudioThreadAllocationCheck allocationCheck;
+    MULTIEFFECTOR_TIME_BLOCK(stageTimings);
     
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -175,65 +263,303 @@ void _3BandMultiEffectorAudioProcessor::processBlock(juce::AudioBuffer<float>& b
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Oversample the input buffer
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto oversampledBlock = oversampler.processSamplesUp(block);
+    // Read the parameters at every control block boundary in this block, even while
+    // sleeping, so the boundaries stay where they are. The crossovers and band settings
+    // change from one segment to the next; everything that can only change between
+    // host blocks goes by the settings the block starts with.
+    const auto& segments = controlBlocks.split(buffer.getNumSamples(), [this] { return parameterSnapshot.load(); });
+    const auto& chainSettings = segments.front().settings;
+
+    // Once silence has gone in for longer than the tail, and the output has died away,
+    // nothing but silence can come out until the input changes
+    const auto numBufferSamples = buffer.getNumSamples();
+    const bool inputSilent = isSilent(buffer, totalNumInputChannels);
+    silentInputSamples = inputSilent ? juce::jmin(silentInputSamples + numBufferSamples, std::numeric_limits<int>::max() - numBufferSamples) : 0;
+
+    if (sleeping && inputSilent)
+    {
+        buffer.clear();
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+        return;
+    }
+
+    // Both paths start again from a cleared state, like after prepareToPlay
+    if (sleeping)
+    {
+        sleeping = false;
+        oversampledPathRunning = false;
+        bypassPathRunning = false;
+        warmedUpSamples = 0;
+        oversampledPathGain.setCurrentAndTargetValue(audiblePath == ProcessingPath::Oversampled ? 1.0f : 0.0f);
+    }
+
+    // A new oversampler is built in the background when the factor or filter changes.
+    // The block that picks it up still runs through the old one and fades out, the new
+    // one takes over from the next block, and the output stays muted until the EQ and
+    // crossover have been redesigned for the new rate.
+    path.oversamplingDesigner.requestStage(getOversamplingSetup(chainSettings));
+    auto* newOversampling = path.oversamplingDesigner.getNewStage();
+
+    if (chainSettings.crossoverMode != activeCrossoverMode)
+        switchCrossoverMode(path, chainSettings.crossoverMode);
 
     // Update filters and parameters (at oversampled rate)
-    updateFilters();
+    updateFilters(path, chainSettings);
+    updateTailLength(path, chainSettings);
+
+    // Only a Nonlinear band needs the oversampled path. When that changes, the path being
+    // switched to runs alongside the audible one until its filters and delays hold the
+    // current signal, then the output crossfades to it over pathCrossfadeSeconds, for as
+    // many blocks as that takes. Both paths keep running until the crossfade is over.
+    const auto wantedPath = hasNonlinearBand(chainSettings) ? ProcessingPath::Oversampled : ProcessingPath::Bypass;
+    const bool switching = wantedPath != audiblePath;
+    const bool fading = oversampledPathGain.isSmoothing();
+    const bool runOversampled = audiblePath == ProcessingPath::Oversampled || switching || fading;
+    const bool runBypass = audiblePath == ProcessingPath::Bypass || switching || fading;
+
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    const auto numSamples = block.getNumSamples();
+
+    // When both paths run, the bypass path works on a copy of the input
+    auto bypassBlock = block;
+    if (runBypass)
+    {
+        if (runOversampled)
+        {
+            bypassBlock = path.scratchArena.getBypassBlock(numSamples).getSubsetChannelBlock(0, block.getNumChannels());
+            bypassBlock.copyFrom(block);
+        }
 
-    // Process left and right channels at oversampled rate
-    auto leftBlock = oversampledBlock.getSingleChannelBlock(0);
-    auto rightBlock = oversampledBlock.getSingleChannelBlock(1);
+        if (! bypassPathRunning)
+            path.bypassPath.reset();
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+        MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::bypassPath);
+        for (const auto& segment : segments)
+        {
+            path.bypassPath.setCrossovers(segment.settings.crossovers, activeCrossoverMode);
+            path.bypassPath.process(bypassBlock.getSubBlock((size_t) segment.start, (size_t) segment.length),
+                                    path.scratchArena.getInterleavedBlock((size_t) segment.length));
+        }
+    }
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if (runOversampled)
+    {
+        if (! oversampledPathRunning)
+            resetOversampledPath(path);
 
-    auto chainSettings = getChainSettings(apvts);
+        processOversampledPath(path, block, segments);
 
-    // Update crossovers
-    leftCrossover.update(chainSettings.crossoverLow, chainSettings.crossoverHigh);
-    rightCrossover.update(chainSettings.crossoverLow, chainSettings.crossoverHigh);
-    
-    // Update band distortions
-    updateBandDistortion(leftBands[0], chainSettings.lowBand, chainSettings);
-    updateBandDistortion(leftBands[1], chainSettings.midBand, chainSettings);
-    updateBandDistortion(leftBands[2], chainSettings.highBand, chainSettings);
-    updateBandDistortion(rightBands[0], chainSettings.lowBand, chainSettings);
-    updateBandDistortion(rightBands[1], chainSettings.midBand, chainSettings);
-    updateBandDistortion(rightBands[2], chainSettings.highBand, chainSettings);
-
-    // Convert oversampledBlock to AudioBuffer for EQ'd signal
-    juce::AudioBuffer<float> eqBuffer(oversampledBlock.getNumChannels(), oversampledBlock.getNumSamples());
-    eqBuffer.copyFrom(0, 0, oversampledBlock.getChannelPointer(0), oversampledBlock.getNumSamples());
-    eqBuffer.copyFrom(1, 0, oversampledBlock.getChannelPointer(1), oversampledBlock.getNumSamples());
-
-    // Create an output AudioBuffer for band processing
-    juce::AudioBuffer<float> outputBuffer(oversampledBlock.getNumChannels(), oversampledBlock.getNumSamples());
-    outputBuffer.clear();
-
-    // Process each band at oversampled rate
-    processBand(eqBuffer, outputBuffer, 0, leftCrossover.lowPassL, rightCrossover.lowPassL, leftBands[0], rightBands[0]);
-    processBand(eqBuffer, outputBuffer, 1, leftCrossover.highPassM, rightCrossover.highPassM, leftBands[1], rightBands[1]);
-    processBand(eqBuffer, outputBuffer, 2, leftCrossover.highPassH, rightCrossover.highPassH, leftBands[2], rightBands[2]);
-
-    // Create an AudioBlock from the outputBuffer to match the oversampledBlock type
-    juce::dsp::AudioBlock<float> outputBlock(outputBuffer);
-
-    // Copy the processed output from outputBlock to oversampledBlock
-    oversampledBlock.copyFrom(outputBlock);
+        if (waitingForDesigns && newOversampling == nullptr && filtersMatchOversampledRate(path))
+        {
+            buffer.applyGainRamp(0, buffer.getNumSamples(), 0.0f, 1.0f);
+            waitingForDesigns = false;
+        }
+        else if (waitingForDesigns)
+        {
+            buffer.clear();
+        }
+        else if (newOversampling != nullptr)
+        {
+            buffer.applyGainRamp(0, buffer.getNumSamples(), 1.0f, 0.0f);
+        }
+    }
+    else if (waitingForDesigns && filtersMatchOversampledRate(path))
+    {
+        waitingForDesigns = false;
+    }
 
-    // Downsample back to original rate
-    oversampler.processSamplesDown(block);
+    oversampledPathRunning = runOversampled;
+    bypassPathRunning = runBypass;
+
+    if (switching)
+    {
+        // A path that is still fading out never stopped, so it can fade straight back in
+        warmedUpSamples = fading ? getWarmupSamples() : warmedUpSamples + (int) numSamples;
+        const bool ready = warmedUpSamples >= getWarmupSamples()
+                        && (wantedPath == ProcessingPath::Bypass || ! waitingForDesigns);
+
+        if (ready)
+        {
+            oversampledPathGain.setTargetValue(wantedPath == ProcessingPath::Oversampled ? 1.0f : 0.0f);
+            audiblePath = wantedPath;
+            warmedUpSamples = 0;
+        }
+    }
+    else
+    {
+        warmedUpSamples = 0;
+    }
+
+    // block holds the oversampled path's output and bypassBlock the bypass path's
+    if (runOversampled && runBypass)
+    {
+        if (oversampledPathGain.isSmoothing())
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto gain = static_cast<SampleType>(oversampledPathGain.getNextValue());
+
+                for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                {
+                    const auto bypassed = bypassBlock.getSample((int) channel, (int) i);
+                    block.setSample((int) channel, (int) i, bypassed + (block.getSample((int) channel, (int) i) - bypassed) * gain);
+                }
+            }
+        }
+        else if (audiblePath == ProcessingPath::Bypass)
+        {
+            block.copyFrom(bypassBlock);
+        }
+    }
+
+    if (newOversampling != nullptr)
+        installOversampling(path, *newOversampling);
+
+    const auto tailSamples = juce::roundToInt(tailLengthSeconds.load() * getSampleRate());
+    if (inputSilent && silentInputSamples >= tailSamples && isSilent(buffer, totalNumOutputChannels))
+    {
+        sleeping = true;
+        buffer.clear();
+    }
 
     // Update FIFO buffers with the downsampled buffer for visualization
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
 }
 
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::processOversampledPath(SignalPath<SampleType>& path, const juce::dsp::AudioBlock<SampleType>& block, const std::vector<ControlBlocks::Segment>& segments)
+{
+    const auto& chainSettings = segments.front().settings;
+    auto& oversampler = path.oversampling->oversampler;
+
+    // Oversample the input buffer
+    juce::dsp::AudioBlock<SampleType> oversampledBlock;
+    {
+        MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::oversampleUp);
+        oversampledBlock = oversampler.processSamplesUp(block);
+    }
+
+    // Run the EQ on a whole group of channels at once, at the oversampled rate
+    auto numOversampledSamples = oversampledBlock.getNumSamples();
+    {
+        MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::eq);
+        auto interleavedBlock = path.scratchArena.getInterleavedBlock(numOversampledSamples);
+        interleaveChannels(oversampledBlock, interleavedBlock);
+        path.eqChain.process(interleavedBlock);
+        deinterleaveChannels(interleavedBlock, oversampledBlock);
+    }
+
+    // Split the EQ'd signal into the band buffers in one pass
+    typename CrossoverFilters<SampleType>::BandBlocks bandBlocks;
+    for (size_t band = 0; band < bandBlocks.size(); ++band)
+        bandBlocks[band] = path.scratchArena.getBandBlock((int) band, numOversampledSamples);
+
+    // The Linkwitz-Riley filters are retuned at every control block boundary, on the
+    // way in and again for the allpasses on the way back
+    const auto factor = (size_t) path.oversampling->getFactor();
+    auto getSegmentBands = [&](const ControlBlocks::Segment& segment)
+    {
+        typename CrossoverFilters<SampleType>::BandBlocks segmentBands;
+        for (size_t band = 0; band < segmentBands.size(); ++band)
+            segmentBands[band] = bandBlocks[band].getSubBlock((size_t) segment.start * factor, (size_t) segment.length * factor);
+        return segmentBands;
+    };
+
+    {
+        MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::crossoverSplit);
+        if (activeCrossoverMode == CrossoverMode::LinearPhase)
+        {
+            // The kernels are swapped at partition boundaries, so the newest settings are
+            // all a design needs
+            linearPhaseCrossover.requestDesign(segments.back().settings.crossovers);
+            linearPhaseCrossover.split(oversampledBlock, bandBlocks);
+        }
+        else
+        {
+            for (const auto& segment : segments)
+            {
+                path.crossover.update(segment.settings.crossovers);
+                path.crossover.split(oversampledBlock.getSubBlock((size_t) segment.start * factor, (size_t) segment.length * factor),
+                                     getSegmentBands(segment));
+            }
+        }
+    }
+
+    // Process each band at oversampled rate. Inactive bands keep their crossover filters
+    // running, so they come back without a click, but their distortion starts afresh.
+    path.bandJobs.jobs.clear();
+    path.bandJobs.segments = &segments;
+    path.bandJobs.factor = factor;
+
+    for (size_t band = 0; band < bandBlocks.size(); ++band)
+    {
+        const bool active = std::any_of(segments.begin(), segments.end(), [band](const ControlBlocks::Segment& segment) {
+            return getBandActivity(segment.settings.bands[band]) != BandActivity::Inactive;
+        });
+
+        if (! active)
+        {
+            for (auto& bands : path.channelBands)
+                bands[band].reset();
+            continue;
+        }
+
+        addBandJobs(path, bandBlocks[band], band);
+    }
+
+    runBandJobs(path, chainSettings, (int) block.getNumSamples());
+
+    // Sum the bands back into oversampledBlock
+    {
+        MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::recombine);
+        if (activeCrossoverMode == CrossoverMode::LinearPhase)
+        {
+            linearPhaseCrossover.recombine(bandBlocks, oversampledBlock);
+        }
+        else
+        {
+            for (const auto& segment : segments)
+            {
+                path.crossover.update(segment.settings.crossovers);
+                path.crossover.recombine(getSegmentBands(segment),
+                                         oversampledBlock.getSubBlock((size_t) segment.start * factor, (size_t) segment.length * factor));
+            }
+        }
+    }
+
+    // Downsample back to original rate
+    MULTIEFFECTOR_TIME_STAGE(stageTimings, StageTimings::oversampleDown);
+    oversampler.processSamplesDown(block);
+}
+
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::resetOversampledPath(SignalPath<SampleType>& path)
+{
+    path.oversampling->oversampler.reset();
+    path.eqChain.reset();
+    path.crossover.reset();
+    linearPhaseCrossover.reset();
+
+    for (auto& bands : path.channelBands)
+        for (auto& band : bands)
+            band.reset();
+}
+
+bool _3BandMultiEffectorAudioProcessor::hasNonlinearBand(const ChainSettings& chainSettings)
+{
+    return std::any_of(chainSettings.bands.begin(), chainSettings.bands.end(), [](const BandSettings& band) {
+        return getBandActivity(band) == BandActivity::Nonlinear;
+    });
+}
+
+int _3BandMultiEffectorAudioProcessor::getWarmupSamples() const
+{
+    // Long enough to fill the longer path's delays, plus 10 ms for the filters to settle
+    return getLatencySamples() + juce::roundToInt(getSampleRate() * 0.01);
+}
+
 //==============================================================================
 bool _3BandMultiEffectorAudioProcessor::hasEditor() const
 {
@@ -263,225 +589,365 @@ void _3BandMultiEffectorAudioProcessor::setStateInformation (const void* data, i
     // whose contents will have been created by the getStateInformation() call.
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid()) {
+        // The coefficient designer picks up the new values on the next block
         apvts.replaceState(tree);
-        updateFilters();
     }
 }
 
 //============================================================================== Helper Functions ==============================================================================//
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
 {
-    ChainSettings settings;
+    return ParameterSnapshot(apvts).load();
+}
+
+juce::String getBandParameterPrefix(int bandIndex)
+{
+    if (numBands == 3)
+        return juce::StringArray { "LowBand", "MidBand", "HighBand" }[bandIndex];
+
+    return "Band" + juce::String(bandIndex + 1);
+}
+
+juce::String getBandName(int bandIndex)
+{
+    if (numBands == 3)
+        return juce::StringArray { "Low Band", "Mid Band", "High Band" }[bandIndex];
+
+    return "Band " + juce::String(bandIndex + 1);
+}
+
+juce::String getCrossoverParameterID(int crossoverIndex)
+{
+    if (numBands == 3)
+        return crossoverIndex == 0 ? "CrossoverLow" : "CrossoverHigh";
+
+    return "Crossover" + juce::String(crossoverIndex + 1);
+}
+
+juce::String getCrossoverName(int crossoverIndex)
+{
+    if (numBands == 3)
+        return crossoverIndex == 0 ? "Crossover Low" : "Crossover High";
+
+    return "Crossover " + juce::String(crossoverIndex + 1);
+}
+
+ParameterSnapshot::ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts)
+{
+    lowCutFreq = apvts.getRawParameterValue("Low-Cut Frequency");
+    highCutFreq = apvts.getRawParameterValue("High-Cut Frequency");
+    peakFreq = apvts.getRawParameterValue("Peak Frequency");
+    peakGain = apvts.getRawParameterValue("Peak Gain");
+    peakQuality = apvts.getRawParameterValue("Peak Quality");
+    lowCutSlope = apvts.getRawParameterValue("Low-Cut Slope");
+    highCutSlope = apvts.getRawParameterValue("High-Cut Slope");
+    
+    oversamplingFactor = apvts.getRawParameterValue("OversamplingFactor");
+    oversamplingFilter = apvts.getRawParameterValue("OversamplingFilter");
+    crossoverMode = apvts.getRawParameterValue("CrossoverMode");
+    parallelBands = apvts.getRawParameterValue("ParallelBands");
+    parallelThreshold = apvts.getRawParameterValue("ParallelThreshold");
+    controlBlockSize = apvts.getRawParameterValue("ControlBlockSize");
+    for (int i = 0; i < numCrossovers; ++i)
+        crossovers[(size_t) i] = apvts.getRawParameterValue(getCrossoverParameterID(i));
+    
+    levelCompensation = apvts.getRawParameterValue("LevelCompensation");
+    compensationAttack = apvts.getRawParameterValue("CompensationAttack");
+    compensationRelease = apvts.getRawParameterValue("CompensationRelease");
+    shaperQuality = apvts.getRawParameterValue("ShaperQuality");
+    
+    for (int i = 0; i < numBands; ++i)
+        bands[(size_t) i] = getBandParameters(apvts, getBandParameterPrefix(i));
+}
+
+ParameterSnapshot::BandParameters ParameterSnapshot::getBandParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& prefix)
+{
+    BandParameters band;
+    band.type = apvts.getRawParameterValue(prefix + "Type");
+    band.drive = apvts.getRawParameterValue(prefix + "Drive");
+    band.postGain = apvts.getRawParameterValue(prefix + "PostGain");
+    band.mix = apvts.getRawParameterValue(prefix + "Mix");
     
-    settings.lowCutFreq = apvts.getRawParameterValue("Low-Cut Frequency")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("High-Cut Frequency")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Frequency")->load();
-    settings.peakGainInDeciibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("Low-Cut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("High-Cut Slope")->load());
+    jassert(band.type != nullptr && band.drive != nullptr && band.postGain != nullptr && band.mix != nullptr);
+    return band;
+}
+
+BandSettings ParameterSnapshot::loadBand(const BandParameters& band)
+{
+    BandSettings settings;
+    settings.type = static_cast<DistortionType>(band.type->load());
+    settings.drive = band.drive->load();
+    settings.postGain = band.postGain->load();
+    settings.mix = band.mix->load();
+    return settings;
+}
+
+ChainSettings ParameterSnapshot::load() const
+{
+    ChainSettings settings;
     
-    settings.crossoverLow = apvts.getRawParameterValue("CrossoverLow")->load();
-    settings.crossoverHigh = apvts.getRawParameterValue("CrossoverHigh")->load();
+    settings.lowCutFreq = lowCutFreq->load();
+    settings.highCutFreq = highCutFreq->load();
+    settings.peakFreq = peakFreq->load();
+    settings.peakGainInDeciibels = peakGain->load();
+    settings.peakQuality = peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
     
-    settings.levelCompensation = apvts.getRawParameterValue("LevelCompensation")->load();
+    settings.oversamplingOrder = static_cast<int>(oversamplingFactor->load());
+    settings.oversamplingFilter = static_cast<OversamplingFilter>(oversamplingFilter->load());
+    settings.crossoverMode = static_cast<CrossoverMode>(crossoverMode->load());
+    settings.parallelBands = parallelBands->load() > 0.5f;
+    settings.parallelThreshold = static_cast<int>(parallelThreshold->load());
+    settings.controlBlockSize = ControlBlocks::minBlockSize << static_cast<int>(controlBlockSize->load());
     
-    settings.lowBand.type = static_cast<DistortionType>(apvts.getRawParameterValue("LowBandType")->load());
-    settings.lowBand.drive = apvts.getRawParameterValue("LowBandDrive")->load();
-    settings.lowBand.postGain = apvts.getRawParameterValue("LowBandPostGain")->load();
-    settings.lowBand.mix = apvts.getRawParameterValue("LowBandMix")->load();
+    // The editor keeps the crossovers in order, but automation doesn't have to
+    float lowerCrossover = 0.0f;
+    for (size_t i = 0; i < crossovers.size(); ++i)
+    {
+        settings.crossovers[i] = juce::jmax(crossovers[i]->load(), lowerCrossover);
+        lowerCrossover = settings.crossovers[i];
+    }
     
-    settings.midBand.type = static_cast<DistortionType>(apvts.getRawParameterValue("MidBandType")->load());
-    settings.midBand.drive = apvts.getRawParameterValue("MidBandDrive")->load();
-    settings.midBand.postGain = apvts.getRawParameterValue("MidBandPostGain")->load();
-    settings.midBand.mix = apvts.getRawParameterValue("MidBandMix")->load();
+    settings.levelCompensation = levelCompensation->load();
+    settings.compensationAttackMs = compensationAttack->load();
+    settings.compensationReleaseMs = compensationRelease->load();
+    settings.shaperQuality = static_cast<ShaperQuality>(shaperQuality->load());
     
-    settings.highBand.type = static_cast<DistortionType>(apvts.getRawParameterValue("HighBandType")->load());
-    settings.highBand.drive = apvts.getRawParameterValue("HighBandDrive")->load();
-    settings.highBand.postGain = apvts.getRawParameterValue("HighBandPostGain")->load();
-    settings.highBand.mix = apvts.getRawParameterValue("HighBandMix")->load();
+    for (size_t i = 0; i < bands.size(); ++i)
+        settings.bands[i] = loadBand(bands[i]);
     
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::updateFilters(SignalPath<SampleType>& path, const ChainSettings& chainSettings)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDeciibels));
+    auto oversampledSampleRate = getOversampledRate(path);
+    path.coefficientDesigner.requestDesign(chainSettings, oversampledSampleRate);
+    
+    if (auto* coefficients = path.coefficientDesigner.getNewCoefficients())
+    {
+        coefficients->applyTo(path.eqChain);
+        appliedEqSampleRate = coefficients->sampleRate;
+        eqTailSeconds = coefficients->tailSeconds;
+    }
+    
+    path.bypassCoefficientDesigner.requestDesign(chainSettings, getSampleRate());
+    
+    if (auto* coefficients = path.bypassCoefficientDesigner.getNewCoefficients())
+    {
+        coefficients->applyTo(path.bypassPath.eqChain);
+    }
 }
 
-void _3BandMultiEffectorAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings, float sampleRate)
+OversamplingSetup _3BandMultiEffectorAudioProcessor::getOversamplingSetup(const ChainSettings& chainSettings)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, sampleRate);
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    return { chainSettings.oversamplingOrder, chainSettings.oversamplingFilter };
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements)
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::installOversampling(SignalPath<SampleType>& path, typename OversamplingDesigner<SampleType>::Stage& stage)
 {
-    *old = *replacements;
+    path.oversampling = &stage;
+
+    // prepareToPlay sized all of these for the largest factor, so preparing them again
+    // only changes their rate and clears their state
+    juce::dsp::ProcessSpec oversampledSpec;
+    oversampledSpec.sampleRate = getOversampledRate(path);
+    oversampledSpec.maximumBlockSize = (juce::uint32) (getBlockSize() << OversamplingSetup::maxOrder);
+    oversampledSpec.numChannels = (juce::uint32) path.channelBands.size();
+
+    path.eqChain.reset();
+
+    path.crossover.prepare(oversampledSpec);
+    linearPhaseCrossover.setSampleRate(oversampledSpec.sampleRate);
+
+    auto bandSpec = oversampledSpec;
+    bandSpec.numChannels = 1;
+    for (auto& bands : path.channelBands)
+        for (auto& band : bands)
+            band.prepare(bandSpec);
+
+    waitingForDesigns = true;
+    updateLatency(path);
 }
 
-void _3BandMultiEffectorAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings, float sampleRate)
+template<typename SampleType>
+bool _3BandMultiEffectorAudioProcessor::filtersMatchOversampledRate(const SignalPath<SampleType>& path) const
 {
-    auto lowCutCoefficient = makeLowCutFilter(chainSettings, sampleRate);
-    
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    
-    updateCutFilter(leftLowCut, lowCutCoefficient, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficient, chainSettings.lowCutSlope);
+    if (appliedEqSampleRate != getOversampledRate(path))
+        return false;
+
+    return activeCrossoverMode != CrossoverMode::LinearPhase || linearPhaseCrossover.hasCurrentKernels();
 }
 
-void _3BandMultiEffectorAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings, float sampleRate)
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::updateTailLength(const SignalPath<SampleType>& path, const ChainSettings& chainSettings)
 {
-    auto highCutCoefficient = makeHighCutFilter(chainSettings, sampleRate);
+    // The oversampler's filters are about twice as long as its latency, and the EQ
+    // rings on after them
+    auto seconds = 2.0 * path.oversampling->getLatencyInSamples() / getSampleRate() + eqTailSeconds;
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    if (activeCrossoverMode == CrossoverMode::LinearPhase)
+    {
+        // The whole kernel, plus the partition the input waits in
+        seconds += 2.0 * getCrossoverLatency(path, CrossoverMode::LinearPhase) / getSampleRate();
+    }
+    else
+    {
+        // Every crossover splits, and all but the first have an allpass on the way back
+        for (size_t i = 0; i < chainSettings.crossovers.size(); ++i)
+        {
+            const auto hasAllpass = i > 0;
+            seconds += getLinkwitzRileyDecaySeconds(chainSettings.crossovers[i]) * (hasAllpass ? 2.0 : 1.0);
+        }
+    }
 
-    updateCutFilter(leftHighCut, highCutCoefficient, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficient, chainSettings.highCutSlope);
+    tailLengthSeconds.store(seconds);
 }
 
-void _3BandMultiEffectorAudioProcessor::updateFilters()
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::updateLatency(SignalPath<SampleType>& path)
 {
-    auto chainSettings = getChainSettings(apvts);
-    auto oversampledSampleRate = getSampleRate() * oversampler.getOversamplingFactor();
-    updateLowCutFilters(chainSettings, oversampledSampleRate);
-    updatePeakFilter(chainSettings, oversampledSampleRate);
-    updateHighCutFilters(chainSettings, oversampledSampleRate);
+    const auto latency = path.oversampling->getLatencyInSamples() + getCrossoverLatency(path, activeCrossoverMode);
+    path.bypassPath.setDelay(latency);
+    setLatencySamples(latency);
 }
 
-void CrossoverFilters::prepare(const juce::dsp::ProcessSpec& spec)
+template<typename SampleType>
+int _3BandMultiEffectorAudioProcessor::getCrossoverLatency(const SignalPath<SampleType>& path, CrossoverMode mode) const
 {
-    lowPassL.prepare(spec);
-    highPassM.prepare(spec);
-    lowPassM.prepare(spec);
-    highPassH.prepare(spec);
-
-    // Set each filter's type:
-    lowPassL.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    highPassM.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    lowPassM.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    highPassH.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+    if (mode != CrossoverMode::LinearPhase)
+        return 0;
+
+    // Both the partition size and the kernel length are powers of two, so the delay
+    // divides evenly down to the host rate
+    const auto factor = path.oversampling->getFactor();
+    jassert(linearPhaseCrossover.getLatencyInSamples() % factor == 0);
+    return linearPhaseCrossover.getLatencyInSamples() / factor;
 }
 
-void CrossoverFilters::update(float crossoverLow, float crossoverHigh) {
-    lowPassL.setCutoffFrequency(crossoverLow);
-    highPassM.setCutoffFrequency(crossoverLow);
-    lowPassM.setCutoffFrequency(crossoverHigh);
-    highPassH.setCutoffFrequency(crossoverHigh);
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::switchCrossoverMode(SignalPath<SampleType>& path, CrossoverMode mode)
+{
+    // The crossover being switched to starts from silence rather than from whatever
+    // it held when it was last used
+    if (mode == CrossoverMode::LinearPhase)
+        linearPhaseCrossover.reset();
+    else
+        path.crossover.reset();
+
+    activeCrossoverMode = mode;
+    updateLatency(path);
 }
 
+template<typename SampleType>
 void _3BandMultiEffectorAudioProcessor::updateBandDistortion(
-    Distortion<float>& distortionProcessor,
+    Distortion<SampleType>& distortionProcessor,
     const BandSettings& bandSettings,
     const ChainSettings& chainSettings)
 {
     // Set parameters for this band's distortion
     float drive = bandSettings.drive;
-    distortionProcessor.setDrive(drive);
+    distortionProcessor.setType(bandSettings.type);
+    distortionProcessor.setQuality(chainSettings.shaperQuality);
     
     switch (bandSettings.type) {
-        case DistortionType::SoftClipping:
-            distortionProcessor.setWaveshaperFunction([](float x) { return std::tanh(x); });
-            break;
-        case DistortionType::HardClipping:
-            distortionProcessor.setWaveshaperFunction([](float x) { return juce::jlimit (float (-0.1), float (0.1), x); });
-            break;
-        case DistortionType::ArcTan:
-            distortionProcessor.setWaveshaperFunction([](float x) -> float { return 2 / M_PI * std::atan(x); });
-            break;
         case DistortionType::BitCrusher:
-            distortionProcessor.reduceBitDepth(bandSettings.drive);
+            distortionProcessor.setDrive(drive);
+            distortionProcessor.reduceBitDepth(drive);
             break;
         case DistortionType::SineFolding:
             distortionProcessor.setDrive(drive / 5);
-            distortionProcessor.setWaveshaperFunction([](float x) { return std::sin(x); });
             break;
         default:
-            distortionProcessor.setWaveshaperFunction([](float x) { return std::tanh(x); });
+            distortionProcessor.setDrive(drive);
             break;
     }
     
-    
-    
     distortionProcessor.setPostGain(bandSettings.postGain);
+    distortionProcessor.setMix(bandSettings.mix * 0.01f);
+    distortionProcessor.setCompensationTimes(chainSettings.compensationAttackMs, chainSettings.compensationReleaseMs);
 }
 
-void _3BandMultiEffectorAudioProcessor::processBand(
-    const juce::AudioBuffer<float>& eqBuffer,
-    juce::AudioBuffer<float>& output,
-    int bandIndex,
-    juce::dsp::LinkwitzRileyFilter<float>& leftFilter,
-    juce::dsp::LinkwitzRileyFilter<float>& rightFilter,
-    Distortion<float>& leftDistortion,
-    Distortion<float>& rightDistortion)
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::BandJobs<SampleType>::runJob(int index)
 {
-    auto settings = getChainSettings(apvts);
-    BandSettings* bandSettings = nullptr;
-    switch (bandIndex)
-    {
-        case 0: bandSettings = &settings.lowBand; break;
-        case 1: bandSettings = &settings.midBand; break;
-        case 2: bandSettings = &settings.highBand; break;
-        default: jassertfalse; break;
-    }
-    if (!bandSettings)
-        return;
-
-    tempBuffers[bandIndex].makeCopyOf(eqBuffer);
+    auto& job = jobs[(size_t) index];
+    MULTIEFFECTOR_TIME_STAGE(*timings, StageTimings::firstBand + (int) job.band);
 
-    if (bandIndex == 1) // Mid band
+    // Each control block's settings go in just before its samples. The dry/wet mix
+    // happens inside the distortion, against this band's own signal.
+    for (const auto& segment : *segments)
     {
-        auto leftBlock = juce::dsp::AudioBlock<float>(tempBuffers[bandIndex]).getSingleChannelBlock(0);
-        {
-            juce::dsp::ProcessContextReplacing<float> context(leftBlock);
-            leftCrossover.highPassM.process(context);
-            leftCrossover.lowPassM.process(context);
-            if (bandSettings->drive > 0.0f)
-                leftDistortion.process(context, settings.levelCompensation); // Pass compensation flag
-        }
+        const auto& settings = segment.settings;
+        const auto& bandSettings = settings.bands[job.band];
 
-        auto rightBlock = juce::dsp::AudioBlock<float>(tempBuffers[bandIndex]).getSingleChannelBlock(1);
+        // Where the band is Inactive its signal passes through as the crossover split it
+        if (getBandActivity(bandSettings) == BandActivity::Inactive)
         {
-            juce::dsp::ProcessContextReplacing<float> context(rightBlock);
-            rightCrossover.highPassM.process(context);
-            rightCrossover.lowPassM.process(context);
-            if (bandSettings->drive > 0.0f)
-                rightDistortion.process(context, settings.levelCompensation); // Pass compensation flag
+            job.distortion->reset();
+            continue;
         }
+
+        updateBandDistortion(*job.distortion, bandSettings, settings);
+
+        auto segmentBlock = job.block.getSubBlock((size_t) segment.start * factor, (size_t) segment.length * factor);
+        job.distortion->process(juce::dsp::ProcessContextReplacing<SampleType>(segmentBlock), settings.levelCompensation);
     }
-    else // Low and high bands
-    {
-        auto leftBlock = juce::dsp::AudioBlock<float>(tempBuffers[bandIndex]).getSingleChannelBlock(0);
-        {
-            juce::dsp::ProcessContextReplacing<float> context(leftBlock);
-            leftFilter.process(context);
-            if (bandSettings->drive > 0.0f)
-                leftDistortion.process(context, settings.levelCompensation); // Pass compensation flag
-        }
+}
 
-        auto rightBlock = juce::dsp::AudioBlock<float>(tempBuffers[bandIndex]).getSingleChannelBlock(1);
-        {
-            juce::dsp::ProcessContextReplacing<float> context(rightBlock);
-            rightFilter.process(context);
-            if (bandSettings->drive > 0.0f)
-                rightDistortion.process(context, settings.levelCompensation); // Pass compensation flag
-        }
+// runJob() is virtual and only defined here, so both precisions are instantiated here
+// for every other file that sees a BandJobs
+template struct _3BandMultiEffectorAudioProcessor::BandJobs<float>;
+template struct _3BandMultiEffectorAudioProcessor::BandJobs<double>;
+
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::addBandJobs(SignalPath<SampleType>& path, const juce::dsp::AudioBlock<SampleType>& bandBlock, size_t bandIndex)
+{
+    const auto numChannels = juce::jmin(bandBlock.getNumChannels(), path.channelBands.size());
+    auto& jobs = path.bandJobs.jobs;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        jassert(jobs.size() < jobs.capacity());
+        jobs.push_back({ &path.channelBands[channel][bandIndex], bandBlock.getSingleChannelBlock(channel), bandIndex });
     }
+}
 
-    const float wetGain = bandSettings->mix * 0.01f;
-    const float dryGain = 1.0f - wetGain;
+template<typename SampleType>
+void _3BandMultiEffectorAudioProcessor::runBandJobs(SignalPath<SampleType>& path, const ChainSettings& chainSettings, int numHostSamples)
+{
+    auto& bandJobs = path.bandJobs;
+    const auto numJobs = (int) bandJobs.jobs.size();
 
-    for (int ch = 0; ch < output.getNumChannels(); ++ch)
+    // Waking the workers costs more than it saves on small blocks
+    if (chainSettings.parallelBands && numHostSamples >= chainSettings.parallelThreshold
+        && numJobs > 1 && workerPool.getNumWorkers() > 0)
     {
-        output.addFrom(ch, 0, eqBuffer, ch, 0, output.getNumSamples(), dryGain);
-        output.addFrom(ch, 0, tempBuffers[bandIndex], ch, 0, output.getNumSamples(), wetGain);
+        workerPool.run(bandJobs, numJobs);
+        return;
     }
+
+    for (int i = 0; i < numJobs; ++i)
+        bandJobs.runJob(i);
 }
 
 //============================================================================== Parameter Layout ==============================================================================//
+// The 3 band parameters keep the version hints they were released with (the band
+// ones run five apart from 109). IDs that only exist with other band counts arrived
+// with the band count setting, so they all share 128.
+static int getCrossoverVersionHint(int crossoverIndex)
+{
+    return numBands == 3 ? 107 + crossoverIndex : 128;
+}
+
+static int getBandVersionHint(int bandIndex, int parameterOffset)
+{
+    return numBands == 3 ? 109 + bandIndex * 5 + parameterOffset : 128;
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout _3BandMultiEffectorAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -529,39 +995,72 @@ juce::AudioProcessorValueTreeState::ParameterLayout _3BandMultiEffectorAudioProc
     distortionTypeArray.add("Bit Crushing");
     distortionTypeArray.add("Sine Folding");
     
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("CrossoverLow", 107), "Crossover Low",
-        juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), 200.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("CrossoverHigh", 108), "Crossover High",
-        juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), 2000.0f));
-    
-    // Low Band Parameters
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LowBandType", 109), "Low Band Type", distortionTypeArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LowBandDrive", 110), "Low Band Drive",
-        juce::NormalisableRange<float>(0.0f, 50.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LowBandPostGain", 112), "Low Band Post Gain",
-        juce::NormalisableRange<float>(-40.0f, 20.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LowBandMix", 113), "Low Band Mix",
-        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f));
-    
-    // Mid Band Parameters
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("MidBandType", 114), "Mid Band Type", distortionTypeArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("MidBandDrive", 115), "Mid Band Drive",
-        juce::NormalisableRange<float>(0.0f, 50.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("MidBandPostGain", 117), "Mid Band Post Gain",
-        juce::NormalisableRange<float>(-40.0f, 20.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("MidBandMix", 118), "Mid Band Mix",
-        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f));
+    // Crossovers start spaced evenly on a log scale between 20 Hz and 20 kHz,
+    // which puts the 3 band defaults at 200 Hz and 2 kHz
+    for (int i = 0; i < numCrossovers; ++i)
+    {
+        const auto defaultFrequency = 20.0f * std::pow(1000.0f, float(i + 1) / float(numBands));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(getCrossoverParameterID(i), getCrossoverVersionHint(i)),
+            getCrossoverName(i), juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f), std::round(defaultFrequency)));
+    }
     
-    // High Band Parameters
-    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HighBandType", 119), "High Band Type", distortionTypeArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("HighBandDrive", 120), "High Band Drive",
-        juce::NormalisableRange<float>(0.0f, 50.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("HighBandPostGain", 122), "High Band Post Gain",
-        juce::NormalisableRange<float>(-40.0f, 20.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("HighBandMix", 123), "High Band Mix",
-        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f));
+    // Band Parameters
+    for (int i = 0; i < numBands; ++i)
+    {
+        const auto prefix = getBandParameterPrefix(i);
+        const auto name = getBandName(i);
+        
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID(prefix + "Type", getBandVersionHint(i, 0)), name + " Type", distortionTypeArray, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Drive", getBandVersionHint(i, 1)), name + " Drive",
+            juce::NormalisableRange<float>(0.0f, 50.0f, 1.0f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "PostGain", getBandVersionHint(i, 3)), name + " Post Gain",
+            juce::NormalisableRange<float>(-40.0f, 20.0f, 1.0f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(prefix + "Mix", getBandVersionHint(i, 4)), name + " Mix",
+            juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f));
+    }
 
     layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("LevelCompensation", 124), "Level Compensation", true));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("CompensationAttack", 126), "Compensation Attack",
+        juce::NormalisableRange<float>(1.0f, 200.0f, 1.0f, 0.5f), 10.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("CompensationRelease", 127), "Compensation Release",
+        juce::NormalisableRange<float>(10.0f, 1000.0f, 1.0f, 0.5f), 150.0f));
+
+    juce::StringArray shaperQualityArray;
+    shaperQualityArray.add("Exact");
+    shaperQualityArray.add("Fast");
+    shaperQualityArray.add("Table (Linear)");
+    shaperQualityArray.add("Table (Cubic)");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("ShaperQuality", 125), "Shaper Quality", shaperQualityArray, 1));
+
+    juce::StringArray crossoverModeArray;
+    crossoverModeArray.add("Linkwitz-Riley");
+    crossoverModeArray.add("Linear Phase");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("CrossoverMode", 129), "Crossover Mode", crossoverModeArray, 0));
+
+    // The choice index is the oversampling order, up to OversamplingSetup::maxOrder
+    juce::StringArray oversamplingFactorArray;
+    for (int order = 0; order <= OversamplingSetup::maxOrder; ++order)
+        oversamplingFactorArray.add(juce::String(1 << order) + "x");
+
+    juce::StringArray oversamplingFilterArray;
+    oversamplingFilterArray.add("IIR (Polyphase)");
+    oversamplingFilterArray.add("FIR (Linear Phase)");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("OversamplingFactor", 130), "Oversampling", oversamplingFactorArray, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("OversamplingFilter", 131), "Oversampling Filter", oversamplingFilterArray, 0));
+
+    // Spreading the bands over worker threads pays off on large blocks, e.g. offline bounces
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("ParallelBands", 132), "Parallel Bands", false));
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID("ParallelThreshold", 133), "Parallel Threshold", 64, 8192, 1024));
+
+    // The choice index doubles the control block from ControlBlocks::minBlockSize
+    juce::StringArray controlBlockSizeArray;
+    for (int i = 0; i < 6; ++i)
+        controlBlockSizeArray.add(juce::String(ControlBlocks::minBlockSize << i) + " samples");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("ControlBlockSize", 134), "Control Block Size", controlBlockSizeArray, 2));
     
     return layout;
 }
@@ -10,383 +10,60 @@
 
 #include <JuceHeader.h>
 
-template<typename T>
-struct Fifo
-{
-    void prepare(int numChannels, int numSamples)
-    {
-        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
-                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-        for( auto& buffer : buffers)
-        {
-            buffer.setSize(numChannels,
-                           numSamples,
-                           false,   //clear everything?
-                           true,    //including the extra space?
-                           true);   //avoid reallocating if you can?
-            buffer.clear();
-        }
-    } 
-    
-    void prepare(size_t numElements)
-    {
-        static_assert( std::is_same_v<T, std::vector<float>>,
-                      "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
-        for( auto& buffer : buffers )
-        {
-            buffer.clear();
-            buffer.resize(numElements, 0);
-        }
-    }
-    
-    bool push(const T& t)
-    {
-        auto write = fifo.write(1);
-        if( write.blockSize1 > 0 )
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        
-        return false;
-    }
-    
-    bool pull(T& t)
-    {
-        auto read = fifo.read(1);
-        if( read.blockSize1 > 0 )
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        
-        return false;
-    }
-    
-    int getNumAvailableForReading() const
-    {
-        return fifo.getNumReady();
-    }
-private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
-};
-
-enum Channel
-{
-    Right, //effectively 0
-    Left //effectively 1
-};
-
-template<typename BlockType>
-struct SingleChannelSampleFifo
-{
-    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
-    {
-        prepared.set(false);
-    }
-    
-    void update(const BlockType& buffer)
-    {
-        jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
-        
-        for( int i = 0; i < buffer.getNumSamples(); ++i )
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
-    }
-
-    void prepare(int bufferSize)
-    {
-        prepared.set(false);
-        size.set(bufferSize);
-        
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
-        prepared.set(true);
-    }
-    //==============================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
-    bool isPrepared() const { return prepared.get(); }
-    int getSize() const { return size.get(); }
-    //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
-};
-
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-enum DistortionType
-{
-    SoftClipping,
-    HardClipping,
-    ArcTan,
-    BitCrusher,
-    SineFolding
-};
-
-struct BandSettings {
-    DistortionType type{ DistortionType::SoftClipping };
-    float drive{ 0.0f }, postGain{ 0.0f }, mix{ 100.0f };
-};
-
-struct ChainSettings
-{
-    float peakFreq {0}, peakGainInDeciibels{0}, peakQuality{1.f};
-    float lowCutFreq{0}, highCutFreq{0};
-    Slope lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
-    bool levelCompensation {true};
-    DistortionType distortionType {DistortionType::SoftClipping};
-    float crossoverLow{ 200.0f }, crossoverHigh{ 2000.0f };
-    BandSettings lowBand, midBand, highBand;
-};
-
-// A template class for distortion effects
-template <typename FloatType>
-class Distortion
-{
-public:
-    Distortion()
-    {
-        processorChain.template get<waveshaperIndex>().functionToUse = [](FloatType x) { return std::tanh(x); };
-        processorChain.template get<postGainIndex>().setGainDecibels(0.0f);
-        processorChain.template get<compensationGainIndex>().setGainDecibels(0.0f);
-    }
-
-    void prepare(const juce::dsp::ProcessSpec& spec)
-    {
-        processorChain.prepare(spec);
-        lastInputRMS = 0.0f;
-        lastOutputRMS = 0.0f;
-    }
-
-    void setPostGain(FloatType gain)
-    {
-        processorChain.template get<postGainIndex>().setGainDecibels(gain);
-    }
-
-    void setWaveshaperFunction(float (*func)(float))
-    {
-        processorChain.template get<waveshaperIndex>().functionToUse = func;
-    }
-
-    void reduceBitDepth(float bitDepth)
-    {
-        static thread_local float tls_quantizationLevels;
-        tls_quantizationLevels = std::pow(2.0f, bitDepth);
-        processorChain.template get<waveshaperIndex>().functionToUse = [](float x) {
-            return std::round(x * tls_quantizationLevels) / tls_quantizationLevels;
-        };
-    }
-
-    void setDrive(float driveLinear)
-    {
-        processorChain.template get<driveIndex>().setGainLinear(driveLinear);
-    }
-
-    void process(juce::dsp::ProcessContextReplacing<float>& context, bool enableCompensation)
-    {
-        auto& inputBlock = context.getInputBlock();
-        auto& outputBlock = context.getOutputBlock();
-        auto numSamples = inputBlock.getNumSamples();
-        auto numChannels = inputBlock.getNumChannels();
-
-        // Calculate input RMS manually
-        float inputSumSq = 0.0f;
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* channelData = inputBlock.getChannelPointer(channel);
-            for (size_t i = 0; i < numSamples; ++i)
-            {
-                float sample = channelData[i];
-                inputSumSq += sample * sample;
-            }
-        }
-        lastInputRMS = std::sqrt(inputSumSq / (numSamples * numChannels));
-
-        // Process drive and waveshaper
-        processorChain.template get<driveIndex>().process(context);
-        processorChain.template get<waveshaperIndex>().process(context);
-
-        // Calculate output RMS manually after waveshaper
-        float outputSumSq = 0.0f;
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* channelData = outputBlock.getChannelPointer(channel);
-            for (size_t i = 0; i < numSamples; ++i)
-            {
-                float sample = channelData[i];
-                outputSumSq += sample * sample;
-            }
-        }
-        lastOutputRMS = std::sqrt(outputSumSq / (numSamples * numChannels));
-
-        // Apply level compensation if enabled
-        if (enableCompensation && lastInputRMS > 0.0f && lastOutputRMS > 0.0f)
-        {
-            float gainDb = juce::Decibels::gainToDecibels(lastInputRMS / lastOutputRMS);
-            processorChain.template get<compensationGainIndex>().setGainDecibels(gainDb);
-        }
-        else
-        {
-            processorChain.template get<compensationGainIndex>().setGainDecibels(0.0f);
-        }
-
-        // Apply compensation gain and post-gain
-        processorChain.template get<compensationGainIndex>().process(context);
-        processorChain.template get<postGainIndex>().process(context);
-    }
-
-private:
-    enum
-    {
-        driveIndex,
-        waveshaperIndex,
-        compensationGainIndex,
-        postGainIndex
-    };
-
-    juce::dsp::ProcessorChain<
-        juce::dsp::Gain<float>,      // Drive (linear)
-        juce::dsp::WaveShaper<float>, // Waveshaper
-        juce::dsp::Gain<float>,      // Compensation Gain (dB)
-        juce::dsp::Gain<float>       // Post-gain (dB)
-    > processorChain;
-
-    float lastInputRMS = 0.0f;
-    float lastOutputRMS = 0.0f;
-};
-struct CrossoverFilters {
-    juce::dsp::LinkwitzRileyFilter<float> lowPassL, highPassM, lowPassM, highPassH;
-    void prepare(const juce::dsp::ProcessSpec& spec);
-    void update(float crossoverLow, float crossoverHigh);
-    std::array<float, 2> getCutoffFrequencies() const {
-        return { lowPassL.getCutoffFrequency(), highPassH.getCutoffFrequency() };
-    }
-};
+// Parameter IDs and names for the bands and crossovers. A 3 band build keeps the
+// original IDs (LowBand, CrossoverLow, ...) so existing sessions still load;
+// other band counts use Band1..BandN and Crossover1..CrossoverN-1.
+juce::String getBandParameterPrefix(int bandIndex);
+juce::String getBandName(int bandIndex);
+juce::String getCrossoverParameterID(int crossoverIndex);
+juce::String getCrossoverName(int crossoverIndex);
 
 // A reference to the TreeState, which manages and connects parameter states in
 // plugins to the actual processing logic
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-// Defines Filter as an alias for the JUCE Infinite Impulse Response (IIR) filter,
-// which processes audio by applying various frequency-dependent effects like
-// low-pass, high-pass, or peak filters.
-using Filter = juce::dsp::IIR::Filter<float>;
-
-// A chain of four filters
-// Used to construct high-order filters by cascading multiple simple filters
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-// Consists of a low-cut, a peak, and a high-cut filter
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-enum ChainPositions
+// Looks up every parameter's raw value once, at construction, so that filling a
+// ChainSettings on the audio thread is just a series of atomic loads instead of
+// string-keyed lookups into the TreeState.
+struct ParameterSnapshot
 {
-    LowCut,
-    Peak,
-    HighCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+    explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts);
 
-// Updates the coefficients for a specific stage in the filter chain.
-// 'Index' determines which filter stage (e.g., stage 0, 1, 2, or 3) to update.
-// 'chain' is the filter chain containing the filter stages.
-// 'cutCoefficients' is an array of coefficient pointers, each corresponding to a filter stage.
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& cutCoefficients)
-{
-    // Replace the current coefficients of the filter stage with the new coefficients.
-    // This adjusts the filter's behavior (e.g., frequency, slope) for that stage.
-    updateCoefficients(chain.template get<Index>().coefficients, cutCoefficients[Index]);
-    // Enable the filter stage by setting its 'bypassed' state to 'false'.
-    // This ensures the updated filter stage becomes active in the audio processing chain.
-    chain.template setBypassed<Index>(false);
-}
+    ChainSettings load() const;
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& lowCut, const CoefficientType& cutCoefficient, const Slope& lowCutSlope)
-{
-    // Reset all filter stages to bypassed
-    // This ensures that no stages are active unless explicitly set below.
-    lowCut.template setBypassed<0>(true);
-    lowCut.template setBypassed<1>(true);
-    lowCut.template setBypassed<2>(true);
-    lowCut.template setBypassed<3>(true);
-    
-    switch(lowCutSlope)
+private:
+    struct BandParameters
     {
-        case Slope_48:
-        {
-            update<3>(lowCut, cutCoefficient);
-            break;
-        }
-        case Slope_36:
-        {
-            update<2>(lowCut, cutCoefficient);
-            break;
-        }
-        case Slope_24:
-        {
-            update<1>(lowCut, cutCoefficient);
-            break;
-        }
-        case Slope_12:
-        {
-            update<0>(lowCut, cutCoefficient);
-            break;
-        }
-    }
-}
+        std::atomic<float>* type = nullptr;
+        std::atomic<float>* drive = nullptr;
+        std::atomic<float>* postGain = nullptr;
+        std::atomic<float>* mix = nullptr;
+    };
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-}
+    static BandParameters getBandParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& prefix);
+    static BandSettings loadBand(const BandParameters& band);
+
+    std::atomic<float>* lowCutFreq = nullptr;
+    std::atomic<float>* highCutFreq = nullptr;
+    std::atomic<float>* peakFreq = nullptr;
+    std::atomic<float>* peakGain = nullptr;
+    std::atomic<float>* peakQuality = nullptr;
+    std::atomic<float>* lowCutSlope = nullptr;
+    std::atomic<float>* highCutSlope = nullptr;
+    std::atomic<float>* oversamplingFactor = nullptr;
+    std::atomic<float>* oversamplingFilter = nullptr;
+    std::atomic<float>* crossoverMode = nullptr;
+    std::atomic<float>* parallelBands = nullptr;
+    std::atomic<float>* parallelThreshold = nullptr;
+    std::atomic<float>* controlBlockSize = nullptr;
+    std::array<std::atomic<float>*, numCrossovers> crossovers{};
+    std::atomic<float>* levelCompensation = nullptr;
+    std::atomic<float>* compensationAttack = nullptr;
+    std::atomic<float>* compensationRelease = nullptr;
+    std::atomic<float>* shaperQuality = nullptr;
+    std::array<BandParameters, numBands> bands;
+};
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
-}
 //==============================================================================
 /**
 */
@@ -410,6 +87,9 @@ public:
     // The host sends buffers at a regular rate, and this method renders the next block
     // Where the audio processing happens
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    // Hosts with a 64-bit mix bus get the whole chain in double, with no conversion
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -421,6 +101,8 @@ public:
     bool acceptsMidi() const override;
     bool producesMidi() const override;
     bool isMidiEffect() const override;
+    // The time the oversampler, EQ and crossover take to decay to silence, which
+    // processBlock keeps up to date for the current settings
     double getTailLengthSeconds() const override;
 
     //==============================================================================
@@ -447,32 +129,196 @@ public:
     
     Distortion<float> distortionProcessor;
     
+    // Every processBlock against its real-time deadline, read by the editor's debug menu
+    DeadlineMonitor deadlineMonitor;
+    
+   #if MULTIEFFECTOR_STAGE_TIMING
+    // Filled by processBlock, read by the editor's timing overlay
+    StageTimings stageTimings;
+   #endif
+    
 private:
-    MonoChain leftChain, rightChain;
+    // Filled at every control block boundary and handed to everything that needs
+    // parameter values
+    ParameterSnapshot parameterSnapshot{apvts};
+    ControlBlocks controlBlocks;
+    
+    // Coefficients are designed off the audio thread whenever the EQ parameters move
+    juce::SharedResourcePointer<BackgroundDesignThread> designThread;
+    double appliedEqSampleRate = 0.0; // the rate the EQ's current coefficients were designed for
     
-    juce::dsp::Oversampling<float> oversampler{2, 1, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR};
+    // Every channel of every band that is active anywhere in the block is one job. They
+    // are independent between the split and the sum, so large blocks can spread them over
+    // the workerPool. Each job walks through the block's control segments on its own.
+    template<typename SampleType>
+    struct BandJobs : WorkerPool::Batch
+    {
+        struct Job
+        {
+            Distortion<SampleType>* distortion = nullptr;
+            juce::dsp::AudioBlock<SampleType> block;
+            size_t band = 0;
+        };
+        
+        void runJob(int index) override;
+        
+        std::vector<Job> jobs; // reserved in prepareToPlay, so adding one never allocates
+        const std::vector<ControlBlocks::Segment>* segments = nullptr; // in host samples
+        size_t factor = 1; // oversampled samples per host sample
+       #if MULTIEFFECTOR_STAGE_TIMING
+        StageTimings* timings = nullptr;
+       #endif
+    };
+    
+    // Everything that holds samples or coefficients, in the sample type the host
+    // processes in. There is one of these for float and one for double, and
+    // prepareToPlay only prepares the one isUsingDoublePrecision() picks, so the other
+    // never allocates. The rest of the processor's state is shared by both.
+    template<typename SampleType>
+    struct SignalPath
+    {
+        explicit SignalPath(BackgroundDesignThread& threadToUse) : designThread(threadToUse)
+        {
+            designThread.addTimeSliceClient(&coefficientDesigner);
+            designThread.addTimeSliceClient(&oversamplingDesigner);
+            designThread.addTimeSliceClient(&bypassCoefficientDesigner);
+        }
+        
+        ~SignalPath()
+        {
+            designThread.removeTimeSliceClient(&bypassCoefficientDesigner);
+            designThread.removeTimeSliceClient(&oversamplingDesigner);
+            designThread.removeTimeSliceClient(&coefficientDesigner);
+        }
+        
+        MultichannelEQ<SampleType> eqChain;
+        FilterCoefficientDesigner<SampleType> coefficientDesigner;
+        
+        BypassPath<SampleType> bypassPath;
+        FilterCoefficientDesigner<SampleType> bypassCoefficientDesigner; // designs at the host rate
+        
+        // Oversamplers are built off the audio thread too, whenever the factor or filter changes
+        OversamplingDesigner<SampleType> oversamplingDesigner;
+        typename OversamplingDesigner<SampleType>::Stage* oversampling = nullptr; // the one processBlock runs through
+        
+        CrossoverFilters<SampleType> crossover; // one filter state per channel
+        std::vector<std::array<Distortion<SampleType>, numBands>> channelBands; // [channel][band], lowest band first
+        ScratchArena<SampleType> scratchArena; // band buffers at the oversampled rate
+        BandJobs<SampleType> bandJobs;
+        
+        BackgroundDesignThread& designThread;
+        
+        JUCE_DECLARE_NON_COPYABLE(SignalPath)
+    };
     
-    // Update the peak filter coefficients (frequency, gain, and quality factor)
-    // based on user settings stored in ChainSettings
-    void updatePeakFilter(const ChainSettings& chainSettings, float sampleRate);
+    // Used instead of the oversampled path while no band is Nonlinear
+    enum class ProcessingPath { Oversampled, Bypass };
+    ProcessingPath audiblePath = ProcessingPath::Oversampled; // or the one being faded to
+    bool oversampledPathRunning = true, bypassPathRunning = false;
+    int warmedUpSamples = 0; // how long the path being switched to has been running
     
-    void updateLowCutFilters(const ChainSettings& chainSettings, float sampleRate);
-    void updateHighCutFilters(const ChainSettings& chainSettings, float sampleRate);
-    void updateFilters();
-    void updateBandDistortion(Distortion<float>& distortionProcessor, const BandSettings& bandSettings, const ChainSettings& chainSettings);
-    void processBand(
-        const juce::AudioBuffer<float>& eqBuffer,
-        juce::AudioBuffer<float>& output,
-        int bandIndex,
-        juce::dsp::LinkwitzRileyFilter<float>& leftFilter,
-        juce::dsp::LinkwitzRileyFilter<float>& rightFilter,
-        Distortion<float>& leftDistortion,
-        Distortion<float>& rightDistortion);
+    // How much of the output comes from the oversampled path, from 0 to 1. It ramps over
+    // pathCrossfadeSeconds whatever the host block size, so a switch can span blocks.
+    static constexpr double pathCrossfadeSeconds = 0.01;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> oversampledPathGain;
+    
+    template<typename SampleType>
+    void prepareSignalPath(SignalPath<SampleType>& path, double sampleRate, int samplesPerBlock);
+    template<typename SampleType>
+    void processSamples(SignalPath<SampleType>& path, juce::AudioBuffer<SampleType>& buffer);
+    
+    static bool hasNonlinearBand(const ChainSettings& chainSettings);
+    // How long a path has to run before its output can be used
+    int getWarmupSamples() const;
+    template<typename SampleType>
+    void processOversampledPath(SignalPath<SampleType>& path, const juce::dsp::AudioBlock<SampleType>& block, const std::vector<ControlBlocks::Segment>& segments);
+    template<typename SampleType>
+    void resetOversampledPath(SignalPath<SampleType>& path);
+    
+    bool waitingForDesigns = false; // muted after an oversampling change until the filters catch up
+    
+    static OversamplingSetup getOversamplingSetup(const ChainSettings& chainSettings);
+    template<typename SampleType>
+    double getOversampledRate(const SignalPath<SampleType>& path) const { return getSampleRate() * path.oversampling->getFactor(); }
+    // Retunes everything that runs at the oversampled rate, without allocating
+    template<typename SampleType>
+    void installOversampling(SignalPath<SampleType>& path, typename OversamplingDesigner<SampleType>::Stage& stage);
+    // Whether the EQ and crossover have been designed for the current oversampled rate
+    template<typename SampleType>
+    bool filtersMatchOversampledRate(const SignalPath<SampleType>& path) const;
+    // Reports the oversampler and crossover latency to the host
+    template<typename SampleType>
+    void updateLatency(SignalPath<SampleType>& path);
+    
+    // processBlock outputs silence and skips everything else while sleeping, which it
+    // starts once the input has been silent for longer than the tail and the output
+    // has decayed too
+    bool sleeping = false;
+    int silentInputSamples = 0;
+    double eqTailSeconds = 0.0; // from the EQ coefficients in use
+    std::atomic<double> tailLengthSeconds { 0.0 };
+    
+    template<typename SampleType>
+    void updateTailLength(const SignalPath<SampleType>& path, const ChainSettings& chainSettings);
+    
+    // Requests new EQ coefficients if needed and swaps in any that have finished
+    template<typename SampleType>
+    void updateFilters(SignalPath<SampleType>& path, const ChainSettings& chainSettings);
+    // Host latency of a crossover mode, in samples at the host rate
+    template<typename SampleType>
+    int getCrossoverLatency(const SignalPath<SampleType>& path, CrossoverMode mode) const;
+    // Called from processBlock when the crossover mode parameter changes
+    template<typename SampleType>
+    void switchCrossoverMode(SignalPath<SampleType>& path, CrossoverMode mode);
+    template<typename SampleType>
+    static void updateBandDistortion(Distortion<SampleType>& distortionProcessor, const BandSettings& bandSettings, const ChainSettings& chainSettings);
+    
+    WorkerPool workerPool;
+    
+    // Keeps the workerPool empty while Parallel Bands is off, and starts the workers when
+    // it's turned on. It polls the parameter on the design thread, so no thread is ever
+    // started or stopped on the audio thread.
+    struct WorkerPoolSizer : juce::TimeSliceClient
+    {
+        WorkerPoolSizer(WorkerPool& poolToSize, std::atomic<float>& parallelBandsValue)
+            : pool(poolToSize), parallelBands(parallelBandsValue) {}
+        
+        int useTimeSlice() override
+        {
+            update();
+            return pollIntervalMs;
+        }
+        
+        // Not on the audio thread
+        void update() { pool.prepare(parallelBands.load() > 0.5f ? maxWorkers.load() : 0); }
+        
+        std::atomic<int> maxWorkers { 0 }; // set by prepareToPlay
+    private:
+        static constexpr int pollIntervalMs = 50;
+        
+        WorkerPool& pool;
+        std::atomic<float>& parallelBands;
+    };
+    
+    WorkerPoolSizer workerPoolSizer { workerPool, *apvts.getRawParameterValue("ParallelBands") };
+    
+    // Runs each channel of a band through that channel's distortion
+    template<typename SampleType>
+    void addBandJobs(SignalPath<SampleType>& path, const juce::dsp::AudioBlock<SampleType>& bandBlock, size_t bandIndex);
+    template<typename SampleType>
+    void runBandJobs(SignalPath<SampleType>& path, const ChainSettings& chainSettings, int numHostSamples);
+    // The bus channels are the same on input and output, so this is what every per-channel
+    // part of the chain is prepared for
+    int getNumProcessedChannels() const { return juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()); }
     juce::dsp::Oscillator<float> osc;
     juce::dsp::DryWetMixer<float> dryWetMixer;
-    CrossoverFilters leftCrossover, rightCrossover;
-    Distortion<float> leftBands[3], rightBands[3]; // 0: low, 1: mid, 2: high
-    juce::AudioBuffer<float> tempBuffers[3]; // For band processing
+    // Used instead of a path's crossover in LinearPhase mode. It converts to float
+    // internally, so both paths share it.
+    LinearPhaseCrossover linearPhaseCrossover;
+    CrossoverMode activeCrossoverMode = CrossoverMode::LinkwitzRiley;
+    
+    SignalPath<float> floatPath { *designThread };
+    SignalPath<double> doublePath { *designThread };
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_3BandMultiEffectorAudioProcessor)
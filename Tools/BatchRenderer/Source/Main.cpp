@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless batch renderer: runs audio files through the plugin's processor
+    without a host or an editor.
+
+    BatchRenderer [--state file] [--jobs N] [--block N] --output dir inputs...
+
+    --state   A state blob saved by getStateInformation, or a preset holding the
+              parameter tree as XML (.xml). Without one, every file is rendered
+              with the default parameters.
+    --jobs    How many files are rendered at once, each on its own thread with its
+              own processor. Defaults to the number of cores.
+    --block   The host block size the processor is driven with. Defaults to 512.
+    --output  The folder the rendered files are written to, under the same names.
+              Each file keeps its format, sample rate and channel count.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+struct Options
+{
+    juce::File stateFile, outputFolder;
+    juce::Array<juce::File> inputs;
+    int numJobs = juce::SystemStats::getNumCpus();
+    int blockSize = 512;
+};
+
+struct FileResult
+{
+    double audioSeconds = 0.0, renderSeconds = 0.0;
+    juce::String error; // empty when the file was rendered
+};
+
+void printUsage()
+{
+    std::cout << "Usage: BatchRenderer [--state file] [--jobs N] [--block N] --output dir inputs..." << std::endl;
+}
+
+bool parseArguments(const juce::StringArray& arguments, Options& options)
+{
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        const auto& argument = arguments[i];
+
+        if (! argument.startsWith("--"))
+        {
+            options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(argument));
+            continue;
+        }
+
+        if (i + 1 >= arguments.size())
+            return false;
+
+        const auto& value = arguments[++i];
+
+        if (argument == "--state")        options.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (argument == "--output")  options.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (argument == "--jobs")    options.numJobs = value.getIntValue();
+        else if (argument == "--block")   options.blockSize = value.getIntValue();
+        else                              return false;
+    }
+
+    return ! options.inputs.isEmpty() && options.outputFolder != juce::File()
+        && options.numJobs > 0 && options.blockSize > 0;
+}
+
+// Presets are stored as the XML of the parameter tree, so they go through the same
+// setStateInformation() call as a blob saved by a host
+bool loadState(const juce::File& file, juce::MemoryBlock& state)
+{
+    if (! file.hasFileExtension("xml"))
+        return file.loadFileAsData(state) && state.getSize() > 0;
+
+    auto xml = juce::XmlDocument::parse(file);
+    if (xml == nullptr)
+        return false;
+
+    auto tree = juce::ValueTree::fromXml(*xml);
+    if (! tree.isValid())
+        return false;
+
+    juce::MemoryOutputStream stream(state, false);
+    tree.writeToStream(stream);
+    return true;
+}
+
+// Streams one file through a processor a block at a time, so memory use doesn't depend
+// on the length of the file. The processor's latency is skipped at the start of the
+// output and flushed with silence at the end, so the output lines up with the input.
+FileResult renderFile(const juce::File& input, const juce::File& output,
+                      _3BandMultiEffectorAudioProcessor& processor,
+                      juce::AudioFormatManager& formatManager, int blockSize)
+{
+    FileResult result;
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+    if (reader == nullptr)
+        return { 0.0, 0.0, "can't read this file" };
+
+    auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+    if (format == nullptr)
+        return { 0.0, 0.0, "no writer for this format" };
+
+    if (output == input)
+        return { 0.0, 0.0, "the output would overwrite the input" };
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sampleRate = reader->sampleRate;
+    const auto length = reader->lengthInSamples;
+
+    // FLAC stops at 24 bits, so float WAVs come out at the deepest the format can do
+    auto bitsPerSample = (int) reader->bitsPerSample;
+    const auto possibleBitDepths = format->getPossibleBitDepths();
+    if (! possibleBitDepths.contains(bitsPerSample))
+        bitsPerSample = possibleBitDepths.getLast();
+
+    output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(output);
+    if (! stream->openedOk())
+        return { 0.0, 0.0, "can't create " + output.getFullPathName() };
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                            bitsPerSample, reader->metadataValues, 0));
+    if (writer == nullptr)
+        return { 0.0, 0.0, "can't write this channel count or sample rate" };
+
+    stream.release(); // the writer owns it now
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if (! processor.setBusesLayout(layout))
+        return { 0.0, 0.0, "the processor doesn't support " + juce::String(numChannels) + " channels" };
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    juce::int64 samplesRead = 0, samplesWritten = 0;
+    auto samplesToSkip = (juce::int64) processor.getLatencySamples();
+
+    while (samplesWritten < length)
+    {
+        // Past the end of the file the processor gets silence, until its latency is flushed
+        const auto numToRead = (int) juce::jlimit((juce::int64) 0, (juce::int64) blockSize, length - samplesRead);
+        buffer.clear();
+        if (numToRead > 0)
+            reader->read(&buffer, 0, numToRead, samplesRead, true, true);
+        samplesRead += numToRead;
+
+        processor.processBlock(buffer, midi);
+
+        const auto offset = (int) juce::jmin(samplesToSkip, (juce::int64) blockSize);
+        samplesToSkip -= offset;
+
+        const auto numToWrite = (int) juce::jmin((juce::int64) (blockSize - offset), length - samplesWritten);
+        if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer(buffer, offset, numToWrite))
+            return { 0.0, 0.0, "writing failed" };
+
+        samplesWritten += juce::jmax(numToWrite, 0);
+    }
+
+    processor.releaseResources();
+
+    result.audioSeconds = (double) length / sampleRate;
+    result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    return result;
+}
+
+// Takes the next file that nobody has started on until there are none left. Each
+// worker keeps one processor for all of its files, and it's only ever used here.
+class RenderWorker : public juce::Thread
+{
+public:
+    RenderWorker(std::unique_ptr<_3BandMultiEffectorAudioProcessor> processorToUse, const Options& optionsToUse,
+                 std::atomic<int>& nextFileToUse, std::vector<FileResult>& resultsToFill, juce::CriticalSection& outputLockToUse)
+        : juce::Thread("BatchRenderer Worker"),
+          processor(std::move(processorToUse)),
+          options(optionsToUse),
+          nextFile(nextFileToUse),
+          results(resultsToFill),
+          outputLock(outputLockToUse)
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override
+    {
+        for (auto index = nextFile++; index < options.inputs.size(); index = nextFile++)
+        {
+            const auto& input = options.inputs.getReference(index);
+            auto& result = results[(size_t) index];
+            result = renderFile(input, options.outputFolder.getChildFile(input.getFileName()),
+                                *processor, formatManager, options.blockSize);
+
+            const juce::ScopedLock lock(outputLock);
+            if (result.error.isEmpty())
+                std::cout << input.getFileName() << ": " << juce::String(result.audioSeconds / result.renderSeconds, 1) << "x realtime" << std::endl;
+            else
+                std::cout << input.getFileName() << ": " << result.error << std::endl;
+        }
+    }
+
+private:
+    std::unique_ptr<_3BandMultiEffectorAudioProcessor> processor;
+    juce::AudioFormatManager formatManager;
+    const Options& options;
+    std::atomic<int>& nextFile;
+    std::vector<FileResult>& results;
+    juce::CriticalSection& outputLock;
+};
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+    for (int i = 1; i < argc; ++i)
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+
+    Options options;
+    if (! parseArguments(arguments, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    juce::MemoryBlock state;
+    if (options.stateFile != juce::File() && ! loadState(options.stateFile, state))
+    {
+        std::cout << "Can't load the state from " << options.stateFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (! options.outputFolder.createDirectory())
+    {
+        std::cout << "Can't create " << options.outputFolder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::atomic<int> nextFile { 0 };
+    std::vector<FileResult> results((size_t) options.inputs.size());
+    juce::CriticalSection outputLock;
+    juce::OwnedArray<RenderWorker> workers;
+
+    // The processors are built here on the message thread, and only handed over to
+    // their workers once they hold the state
+    const auto numWorkers = juce::jmin(options.numJobs, options.inputs.size());
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto processor = std::make_unique<_3BandMultiEffectorAudioProcessor>();
+        processor->setNonRealtime(true);
+        if (state.getSize() > 0)
+            processor->setStateInformation(state.getData(), (int) state.getSize());
+
+        workers.add(new RenderWorker(std::move(processor), options, nextFile, results, outputLock));
+    }
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto* worker : workers)
+        worker->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    // Per core is the sum of every file's own speed, overall is the batch against the clock
+    double audioSeconds = 0.0, renderSeconds = 0.0;
+    int numFailed = 0;
+    for (const auto& result : results)
+    {
+        if (result.error.isNotEmpty())
+        {
+            ++numFailed;
+            continue;
+        }
+
+        audioSeconds += result.audioSeconds;
+        renderSeconds += result.renderSeconds;
+    }
+
+    std::cout << std::endl
+              << "Rendered " << (int) results.size() - numFailed << " of " << (int) results.size() << " files, "
+              << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 1) << " s on "
+              << numWorkers << " threads" << std::endl;
+
+    if (renderSeconds > 0.0 && wallSeconds > 0.0)
+        std::cout << "Throughput: " << juce::String(audioSeconds / wallSeconds, 1) << "x realtime overall, "
+                  << juce::String(audioSeconds / renderSeconds, 1) << "x realtime per thread" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
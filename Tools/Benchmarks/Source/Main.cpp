@@ -0,0 +1,1443 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Microbenchmarks for the processing chain. Drives the whole processor over a
+    matrix of sample rates, block sizes, distortion types, drive levels and band
+    activity patterns, then in float against double, then each stage on its own
+    in both precisions, then the band jobs on worker pools of different sizes,
+    and writes the results as JSON so runs from different commits can be
+    compared.
+
+    It doubles as the regression suite. With --golden it also renders fixed test
+    signals through a grid of parameter states, null-tests every render against a
+    stored reference, checks that the output doesn't depend on the host block
+    size, and checks the fast waveshaper maths against the standard library.
+    A Debug build also checks that processBlock never allocated during the
+    renders, and that the allocation check really fires.
+    With --baseline every case is compared with an earlier run's JSON, and
+    any case that got too much slower fails.
+
+    The references belong in Tools/Benchmarks/Golden, one WAV per render, next to
+    baseline.json, the results of the run that recorded them. Whenever a change is
+    meant to alter the sound, record both again from the repository root and commit
+    them along with it:
+
+        Benchmarks --record-golden Tools/Benchmarks/Golden --output Tools/Benchmarks/Golden/baseline.json
+
+    and check a build against them with:
+
+        Benchmarks --golden Tools/Benchmarks/Golden --baseline Tools/Benchmarks/Golden/baseline.json
+
+    Timings only compare on the same machine, so the baseline has to come from the
+    machine that checks the builds. Anywhere else, leave --baseline out.
+
+    Benchmarks [--output file] [--seconds S] [--repetitions N] [--filter text]
+               [--golden dir | --record-golden dir] [--null-threshold dB]
+               [--baseline file] [--max-slowdown percent]
+
+    --output          Where the JSON goes. Defaults to benchmark-results.json.
+    --seconds         Audio rendered per repetition of each case. Defaults to 0.25.
+    --repetitions     Every case is timed this many times and the fastest run is
+                      kept, which filters out most scheduling noise. Defaults to 3.
+    --filter          Only runs the cases whose name contains this text.
+    --golden          Checks the golden renders against the references in this
+                      folder. The golden cases are timed like any other case.
+    --record-golden   Writes the golden renders to this folder as the new references.
+    --null-threshold  The loudest difference allowed between two renders of the same
+                      case, in dBFS. Defaults to -100.
+    --baseline        A results file from an earlier run to compare the timings with.
+    --max-slowdown    How much slower than the baseline a case may get, in percent.
+                      Defaults to 10.
+
+    Returns 1 if any check fails.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+namespace
+{
+struct Options
+{
+    juce::File outputFile = juce::File::getCurrentWorkingDirectory().getChildFile("benchmark-results.json");
+    double seconds = 0.25;
+    int repetitions = 3;
+    juce::String filter;
+    
+    juce::File goldenFolder, baselineFile;
+    bool recordGolden = false;
+    float nullThresholdDecibels = -100.0f;
+    double maxSlowdownPercent = 10.0;
+};
+
+bool parseArguments(const juce::StringArray& arguments, Options& options)
+{
+    for (int i = 0; i + 1 < arguments.size(); i += 2)
+    {
+        const auto& argument = arguments[i];
+        const auto& value = arguments[i + 1];
+
+        if (argument == "--output")               options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (argument == "--seconds")         options.seconds = value.getDoubleValue();
+        else if (argument == "--repetitions")     options.repetitions = value.getIntValue();
+        else if (argument == "--filter")          options.filter = value;
+        else if (argument == "--golden")          options.goldenFolder = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (argument == "--baseline")        options.baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (argument == "--null-threshold")  options.nullThresholdDecibels = value.getFloatValue();
+        else if (argument == "--max-slowdown")    options.maxSlowdownPercent = value.getDoubleValue();
+        else if (argument == "--record-golden")
+        {
+            options.goldenFolder = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            options.recordGolden = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return arguments.size() % 2 == 0 && options.seconds > 0.0 && options.repetitions > 0
+        && options.maxSlowdownPercent >= 0.0;
+}
+
+// Noise and a sine at about -12 dBFS, from a fixed seed so every run sees the same input.
+// Double buffers get exactly the float values, so both precisions process the same signal.
+template<typename SampleType>
+void fillTestSignal(juce::AudioBuffer<SampleType>& buffer, double sampleRate)
+{
+    juce::Random random(0x3b4d);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* data = buffer.getWritePointer(channel);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const auto sine = std::sin(juce::MathConstants<double>::twoPi * 220.0 * i / sampleRate);
+            data[i] = (SampleType) (0.125f * (float) sine + 0.125f * (random.nextFloat() * 2.0f - 1.0f));
+        }
+    }
+}
+
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const Options& optionsToUse) : options(optionsToUse) {}
+
+    bool shouldRun(const juce::String& name) const { return options.filter.isEmpty() || name.contains(options.filter); }
+
+    // Calls process, which handles samplesPerCall samples at sampleRate, until it has
+    // covered the requested length of audio, and keeps the fastest of the repetitions
+    template <typename ProcessFunction>
+    void run(const juce::String& name, juce::DynamicObject::Ptr details, int samplesPerCall, double sampleRate, ProcessFunction&& process)
+    {
+        const auto numCalls = juce::jmax(1, juce::roundToInt(options.seconds * sampleRate / samplesPerCall));
+
+        // Warm up the caches and let every filter settle
+        for (int i = 0; i < juce::jmax(1, numCalls / 10); ++i)
+            process();
+
+        auto bestTicks = std::numeric_limits<juce::int64>::max();
+        auto bestCycles = std::numeric_limits<juce::uint64>::max();
+
+        for (int repetition = 0; repetition < options.repetitions; ++repetition)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = readCycleCounter();
+
+            for (int i = 0; i < numCalls; ++i)
+                process();
+
+            bestCycles = juce::jmin(bestCycles, readCycleCounter() - startCycles);
+            bestTicks = juce::jmin(bestTicks, juce::Time::getHighResolutionTicks() - startTicks);
+        }
+
+        const auto numSamples = (double) numCalls * samplesPerCall;
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(bestTicks);
+        const auto nsPerSample = seconds * 1.0e9 / numSamples;
+        const auto realtimeFactor = (numSamples / sampleRate) / seconds;
+
+        details->setProperty("name", name);
+        details->setProperty("ns_per_sample", nsPerSample);
+        details->setProperty("cycles_per_sample", hasCycleCounter() ? juce::var((double) bestCycles / numSamples) : juce::var());
+        details->setProperty("realtime_factor", realtimeFactor);
+        results.add(juce::var(details.get()));
+
+        std::cout << name.paddedRight(' ', 56) << juce::String(nsPerSample, 2).paddedLeft(' ', 10) << " ns/sample"
+                  << juce::String(realtimeFactor, 1).paddedLeft(' ', 10) << "x realtime" << std::endl;
+    }
+
+    const juce::Array<juce::var>& getResults() const { return results; }
+
+private:
+    const Options& options;
+    juce::Array<juce::var> results;
+};
+
+//==============================================================================
+void setParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+{
+    auto* parameter = apvts.getParameter(parameterID);
+    jassert(parameter != nullptr);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+enum class BandActivityPattern { None, Lowest, All };
+
+juce::String getPatternName(BandActivityPattern pattern)
+{
+    switch (pattern)
+    {
+        case BandActivityPattern::None:    return "none";
+        case BandActivityPattern::Lowest:  return "lowest";
+        case BandActivityPattern::All:     return "all";
+    }
+
+    return {};
+}
+
+const juce::StringArray distortionTypeNames { "SoftClipping", "HardClipping", "ArcTan", "BitCrusher", "SineFolding" };
+const juce::StringArray shaperQualityNames { "Exact", "Fast", "TableLinear", "TableCubic" };
+
+// The whole processBlock, stereo, with the default EQ, crossovers and oversampling
+void benchmarkProcessor(BenchmarkRunner& runner)
+{
+    const double sampleRates[] { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const int blockSizes[] { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const float drives[] { 5.0f, 40.0f };
+
+    _3BandMultiEffectorAudioProcessor processor;
+    juce::MidiBuffer midi;
+
+    for (auto sampleRate : sampleRates)
+    {
+        for (auto blockSize : blockSizes)
+        {
+            juce::AudioBuffer<float> input(2, blockSize), buffer(2, blockSize);
+            fillTestSignal(input, sampleRate);
+
+            auto runCase = [&](BandActivityPattern pattern, int type, float drive)
+            {
+                auto name = "processor/" + juce::String(juce::roundToInt(sampleRate)) + "/" + juce::String(blockSize)
+                          + "/" + getPatternName(pattern);
+                if (pattern != BandActivityPattern::None)
+                    name << "/" << distortionTypeNames[type] << "/drive" << juce::roundToInt(drive);
+
+                if (! runner.shouldRun(name))
+                    return;
+
+                for (int band = 0; band < numBands; ++band)
+                {
+                    const auto active = pattern == BandActivityPattern::All || (pattern == BandActivityPattern::Lowest && band == 0);
+                    const auto prefix = getBandParameterPrefix(band);
+                    setParameter(processor.apvts, prefix + "Type", (float) type);
+                    setParameter(processor.apvts, prefix + "Drive", active ? drive : 0.0f);
+                }
+
+                // Preparing designs the filters for these settings straight away
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+
+                juce::DynamicObject::Ptr details(new juce::DynamicObject());
+                details->setProperty("group", "processor");
+                details->setProperty("sample_rate", sampleRate);
+                details->setProperty("block_size", blockSize);
+                details->setProperty("band_activity", getPatternName(pattern));
+                details->setProperty("distortion_type", pattern == BandActivityPattern::None ? juce::var() : juce::var(distortionTypeNames[type]));
+                details->setProperty("drive", pattern == BandActivityPattern::None ? juce::var() : juce::var(drive));
+
+                // The input is copied in every block, as a host would, so a bit crusher
+                // doesn't end up processing its own silence
+                runner.run(name, details, blockSize, sampleRate, [&]
+                {
+                    buffer.makeCopyOf(input, true);
+                    processor.processBlock(buffer, midi);
+                });
+            };
+
+            runCase(BandActivityPattern::None, 0, 0.0f);
+
+            for (auto pattern : { BandActivityPattern::Lowest, BandActivityPattern::All })
+                for (int type = 0; type < distortionTypeNames.size(); ++type)
+                    for (auto drive : drives)
+                        runCase(pattern, type, drive);
+        }
+    }
+}
+
+// The whole processBlock again, with the host asking for float or for double the way a
+// 64-bit mix bus would, so the two paths can be compared case by case
+template<typename SampleType>
+void benchmarkPrecision(BenchmarkRunner& runner, juce::AudioProcessor::ProcessingPrecision precision, const juce::String& precisionName)
+{
+    const double sampleRate = 48000.0;
+    const int blockSizes[] { 64, 512, 2048 };
+
+    _3BandMultiEffectorAudioProcessor processor;
+    processor.setProcessingPrecision(precision);
+    juce::MidiBuffer midi;
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<SampleType> input(2, blockSize), buffer(2, blockSize);
+        fillTestSignal(input, sampleRate);
+
+        for (auto pattern : { BandActivityPattern::None, BandActivityPattern::All })
+        {
+            const auto name = "precision/" + precisionName + "/" + juce::String(juce::roundToInt(sampleRate)) + "/"
+                            + juce::String(blockSize) + "/" + getPatternName(pattern);
+            if (! runner.shouldRun(name))
+                continue;
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                const auto prefix = getBandParameterPrefix(band);
+                setParameter(processor.apvts, prefix + "Type", (float) DistortionType::SoftClipping);
+                setParameter(processor.apvts, prefix + "Drive", pattern == BandActivityPattern::All ? 40.0f : 0.0f);
+            }
+
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::DynamicObject::Ptr details(new juce::DynamicObject());
+            details->setProperty("group", "precision");
+            details->setProperty("precision", precisionName);
+            details->setProperty("sample_rate", sampleRate);
+            details->setProperty("block_size", blockSize);
+            details->setProperty("band_activity", getPatternName(pattern));
+
+            runner.run(name, details, blockSize, sampleRate, [&]
+            {
+                buffer.makeCopyOf(input, true);
+                processor.processBlock(buffer, midi);
+            });
+        }
+    }
+}
+
+// The whole processBlock once more, every band distorting, at each control block size.
+// The cost per sample should follow the control block size and hardly move with the
+// host block size.
+void benchmarkControlRate(BenchmarkRunner& runner)
+{
+    const double sampleRate = 48000.0;
+    const int blockSizes[] { 16, 256, 4096 };
+    const int controlSizeIndices[] { 0, 2, 5 }; // 8, 32 and 256 samples
+
+    _3BandMultiEffectorAudioProcessor processor;
+    juce::MidiBuffer midi;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto prefix = getBandParameterPrefix(band);
+        setParameter(processor.apvts, prefix + "Type", (float) DistortionType::SoftClipping);
+        setParameter(processor.apvts, prefix + "Drive", 40.0f);
+    }
+
+    for (auto blockSize : blockSizes)
+    {
+        juce::AudioBuffer<float> input(2, blockSize), buffer(2, blockSize);
+        fillTestSignal(input, sampleRate);
+
+        for (auto controlSizeIndex : controlSizeIndices)
+        {
+            const auto controlBlockSize = ControlBlocks::minBlockSize << controlSizeIndex;
+            const auto name = "control/" + juce::String(juce::roundToInt(sampleRate)) + "/" + juce::String(blockSize)
+                            + "/" + juce::String(controlBlockSize);
+            if (! runner.shouldRun(name))
+                continue;
+
+            setParameter(processor.apvts, "ControlBlockSize", (float) controlSizeIndex);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::DynamicObject::Ptr details(new juce::DynamicObject());
+            details->setProperty("group", "control");
+            details->setProperty("sample_rate", sampleRate);
+            details->setProperty("block_size", blockSize);
+            details->setProperty("control_block_size", controlBlockSize);
+
+            runner.run(name, details, blockSize, sampleRate, [&]
+            {
+                buffer.makeCopyOf(input, true);
+                processor.processBlock(buffer, midi);
+            });
+        }
+    }
+}
+
+//==============================================================================
+// The stages run at 48 kHz, or at 96 kHz (2x oversampling) where the processor would
+// run them on the oversampled signal, in blocks of 512 samples at that rate
+constexpr double stageHostRate = 48000.0;
+constexpr double stageOversampledRate = 96000.0;
+constexpr int stageBlockSize = 512;
+
+// Every stage runs in both precisions. The float cases keep the names they always had,
+// so older results still compare, and the double ones get "/double" on the end.
+template<typename SampleType>
+juce::String getPrecisionSuffix() { return std::is_same<SampleType, double>::value ? "/double" : ""; }
+
+template<typename SampleType>
+juce::DynamicObject::Ptr makeStageDetails(const juce::String& stage)
+{
+    juce::DynamicObject::Ptr details(new juce::DynamicObject());
+    details->setProperty("group", "stage");
+    details->setProperty("stage", stage);
+    details->setProperty("precision", std::is_same<SampleType, double>::value ? "double" : "float");
+    return details;
+}
+
+template<typename SampleType>
+void benchmarkDistortion(BenchmarkRunner& runner)
+{
+    juce::AudioBuffer<SampleType> input(1, stageBlockSize), buffer(1, stageBlockSize);
+    fillTestSignal(input, stageOversampledRate);
+
+    for (int type = 0; type < distortionTypeNames.size(); ++type)
+    {
+        for (int quality = 0; quality < shaperQualityNames.size(); ++quality)
+        {
+            const auto name = "stage/distortion/" + distortionTypeNames[type] + "/" + shaperQualityNames[quality] + getPrecisionSuffix<SampleType>();
+            if (! runner.shouldRun(name))
+                continue;
+
+            Distortion<SampleType> distortion;
+            distortion.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, 1 });
+            distortion.setType((DistortionType) type);
+            distortion.setQuality((ShaperQuality) quality);
+            distortion.setDrive(type == DistortionType::SineFolding ? 2.0f : 10.0f);
+            distortion.reduceBitDepth(10.0f);
+
+            auto details = makeStageDetails<SampleType>("Distortion");
+            details->setProperty("distortion_type", distortionTypeNames[type]);
+            details->setProperty("shaper_quality", shaperQualityNames[quality]);
+
+            runner.run(name, details, stageBlockSize, stageOversampledRate, [&]
+            {
+                buffer.makeCopyOf(input, true);
+                juce::dsp::AudioBlock<SampleType> block(buffer);
+                distortion.process(juce::dsp::ProcessContextReplacing<SampleType>(block), true);
+            });
+        }
+
+        // How the curves used to run: a drive gain, then juce::dsp::WaveShaper calling
+        // the exact curve through a std::function for every sample, without the level
+        // measurement, compensation or mix. The floor the specialised shapers are
+        // measured against.
+        const auto referenceName = "stage/distortion/" + distortionTypeNames[type] + "/waveshaper-reference" + getPrecisionSuffix<SampleType>();
+        if (! runner.shouldRun(referenceName))
+            continue;
+
+        using ReferenceShaper = juce::dsp::WaveShaper<SampleType, std::function<SampleType(SampleType)>>;
+        juce::dsp::ProcessorChain<juce::dsp::Gain<SampleType>, ReferenceShaper> reference;
+        reference.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, 1 });
+        reference.template get<0>().setGainLinear(type == DistortionType::SineFolding ? SampleType(2) : SampleType(10));
+
+        const auto levels = static_cast<SampleType>(std::exp2(10.0));
+        auto& curve = reference.template get<1>().functionToUse;
+
+        switch ((DistortionType) type)
+        {
+            case DistortionType::HardClipping: curve = [](SampleType x) { return juce::jlimit(SampleType(-0.1), SampleType(0.1), x); }; break;
+            case DistortionType::ArcTan:       curve = [](SampleType x) { return static_cast<SampleType>(2.0 / juce::MathConstants<double>::pi) * std::atan(x); }; break;
+            case DistortionType::BitCrusher:   curve = [levels](SampleType x) { return std::round(x * levels) / levels; }; break;
+            case DistortionType::SineFolding:  curve = [](SampleType x) { return std::sin(x); }; break;
+            case DistortionType::SoftClipping:
+            default:                           curve = [](SampleType x) { return std::tanh(x); }; break;
+        }
+
+        auto details = makeStageDetails<SampleType>("WaveShaper");
+        details->setProperty("distortion_type", distortionTypeNames[type]);
+
+        runner.run(referenceName, details, stageBlockSize, stageOversampledRate, [&]
+        {
+            buffer.makeCopyOf(input, true);
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            reference.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+        });
+    }
+}
+
+template<typename SampleType>
+void benchmarkCrossover(BenchmarkRunner& runner)
+{
+    const auto name = "stage/crossover/LinkwitzRiley" + getPrecisionSuffix<SampleType>();
+    if (! runner.shouldRun(name))
+        return;
+
+    juce::AudioBuffer<SampleType> input(2, stageBlockSize), output(2, stageBlockSize);
+    juce::AudioBuffer<SampleType> bandBuffers(2 * numBands, stageBlockSize);
+    fillTestSignal(input, stageOversampledRate);
+
+    CrossoverFilters<SampleType> crossover;
+    crossover.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, 2 });
+
+    std::array<float, numCrossovers> crossovers {};
+    for (int i = 0; i < numCrossovers; ++i)
+        crossovers[(size_t) i] = 20.0f * std::pow(1000.0f, float(i + 1) / float(numBands));
+    crossover.update(crossovers);
+
+    juce::dsp::AudioBlock<SampleType> bandBlock(bandBuffers);
+    typename CrossoverFilters<SampleType>::BandBlocks bands;
+    for (size_t band = 0; band < bands.size(); ++band)
+        bands[band] = bandBlock.getSubsetChannelBlock(band * 2, 2);
+
+    auto details = makeStageDetails<SampleType>("CrossoverFilters");
+    details->setProperty("num_bands", numBands);
+
+    runner.run(name, details, stageBlockSize, stageOversampledRate, [&]
+    {
+        crossover.split(juce::dsp::AudioBlock<SampleType>(input), bands);
+        crossover.recombine(bands, juce::dsp::AudioBlock<SampleType>(output));
+    });
+}
+
+// MonoChain in either precision
+template<typename SampleType>
+using FilterOf = juce::dsp::IIR::Filter<SampleType>;
+template<typename SampleType>
+using CutFilterOf = juce::dsp::ProcessorChain<FilterOf<SampleType>, FilterOf<SampleType>, FilterOf<SampleType>, FilterOf<SampleType>>;
+template<typename SampleType>
+using MonoChainOf = juce::dsp::ProcessorChain<CutFilterOf<SampleType>, FilterOf<SampleType>, CutFilterOf<SampleType>>;
+
+// Every EQ stage in use: both cuts at 48 dB/Oct and a peak that boosts
+ChainSettings getStageEQSettings()
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 40.0f;
+    settings.highCutFreq = 16000.0f;
+    settings.lowCutSlope = Slope::Slope_48;
+    settings.highCutSlope = Slope::Slope_48;
+    settings.peakFreq = 750.0f;
+    settings.peakGainInDeciibels = 6.0f;
+    return settings;
+}
+
+template<typename SampleType>
+void benchmarkMonoChain(BenchmarkRunner& runner)
+{
+    const auto name = "stage/monochain" + getPrecisionSuffix<SampleType>();
+    if (! runner.shouldRun(name))
+        return;
+
+    juce::AudioBuffer<SampleType> input(1, stageBlockSize), buffer(1, stageBlockSize);
+    fillTestSignal(input, stageOversampledRate);
+
+    MonoChainOf<SampleType> chain;
+    chain.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, 1 });
+    const auto coefficients = FilterCoefficientDesigner<SampleType>::design(getStageEQSettings(), stageOversampledRate);
+    coefficients->applyTo(chain);
+
+    runner.run(name, makeStageDetails<SampleType>("MonoChain"), stageBlockSize, stageOversampledRate, [&]
+    {
+        buffer.makeCopyOf(input, true);
+        juce::dsp::AudioBlock<SampleType> block(buffer);
+        chain.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+    });
+}
+
+// The stereo EQ at 96 kHz both ways: the MultichannelEQ the processor runs, with the
+// channels interleaved into its SIMD lanes and back again as processOversampledPath
+// does, against a scalar MonoChain per channel
+template<typename SampleType>
+void benchmarkMultichannelEQ(BenchmarkRunner& runner)
+{
+    constexpr int numChannels = 2;
+    const auto multichannelName = "stage/eq/multichannel" + getPrecisionSuffix<SampleType>();
+    const auto monoChainsName = "stage/eq/two-monochains" + getPrecisionSuffix<SampleType>();
+
+    juce::AudioBuffer<SampleType> input(numChannels, stageBlockSize), buffer(numChannels, stageBlockSize);
+    fillTestSignal(input, stageOversampledRate);
+    const auto coefficients = FilterCoefficientDesigner<SampleType>::design(getStageEQSettings(), stageOversampledRate);
+
+    if (runner.shouldRun(multichannelName))
+    {
+        MultichannelEQ<SampleType> eq;
+        eq.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, (juce::uint32) numChannels });
+        coefficients->applyTo(eq);
+
+        ScratchArena<SampleType> arena;
+        arena.prepare(numChannels, stageBlockSize, numBands);
+        const auto interleaved = arena.getInterleavedBlock((size_t) stageBlockSize);
+
+        auto details = makeStageDetails<SampleType>("MultichannelEQ");
+        details->setProperty("channels", numChannels);
+
+        runner.run(multichannelName, details, stageBlockSize, stageOversampledRate, [&]
+        {
+            buffer.makeCopyOf(input, true);
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            interleaveChannels(block, interleaved);
+            eq.process(interleaved);
+            deinterleaveChannels(interleaved, block);
+        });
+    }
+
+    if (runner.shouldRun(monoChainsName))
+    {
+        std::array<MonoChainOf<SampleType>, numChannels> chains;
+        for (auto& chain : chains)
+        {
+            chain.prepare({ stageOversampledRate, (juce::uint32) stageBlockSize, 1 });
+            coefficients->applyTo(chain);
+        }
+
+        auto details = makeStageDetails<SampleType>("MonoChain");
+        details->setProperty("channels", numChannels);
+
+        runner.run(monoChainsName, details, stageBlockSize, stageOversampledRate, [&]
+        {
+            buffer.makeCopyOf(input, true);
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+
+            for (size_t channel = 0; channel < (size_t) numChannels; ++channel)
+            {
+                auto channelBlock = block.getSingleChannelBlock(channel);
+                chains[channel].process(juce::dsp::ProcessContextReplacing<SampleType>(channelBlock));
+            }
+        });
+    }
+}
+
+template<typename SampleType>
+void benchmarkOversampling(BenchmarkRunner& runner)
+{
+    const juce::String filterNames[] { "IIR", "FIR" };
+
+    juce::AudioBuffer<SampleType> input(2, stageBlockSize), buffer(2, stageBlockSize);
+    fillTestSignal(input, stageHostRate);
+
+    for (int order = 1; order <= OversamplingSetup::maxOrder; ++order)
+    {
+        for (int filter = 0; filter < 2; ++filter)
+        {
+            const auto name = "stage/oversampling/" + juce::String(1 << order) + "x/" + filterNames[filter] + getPrecisionSuffix<SampleType>();
+            if (! runner.shouldRun(name))
+                continue;
+
+            typename OversamplingDesigner<SampleType>::Stage stage({ order, (OversamplingFilter) filter }, 2, stageBlockSize);
+
+            auto details = makeStageDetails<SampleType>("Oversampling");
+            details->setProperty("factor", 1 << order);
+            details->setProperty("filter", filterNames[filter]);
+
+            // Up and back down again, timed against the host rate
+            runner.run(name, details, stageBlockSize, stageHostRate, [&]
+            {
+                buffer.makeCopyOf(input, true);
+                juce::dsp::AudioBlock<SampleType> block(buffer);
+                stage.oversampler.processSamplesUp(block);
+                stage.oversampler.processSamplesDown(block);
+            });
+        }
+    }
+}
+
+// The band distortions of a 7.1 host block at 2x oversampling, handed to a worker
+// pool the way runBandJobs does, so the cost of waking the workers and waiting for
+// them shows against the work itself. With 0 workers the caller runs every job alone.
+// Eight channels give every one of up to 8 threads work, so the sweep goes from 0 to
+// 7 workers, but like the processor never past one thread per core, caller included.
+void benchmarkWorkerPool(BenchmarkRunner& runner)
+{
+    constexpr int maxWorkers = 7;
+    const int blockSizes[] { 32, 64, 128, 256, 512, 1024 };
+    constexpr int numChannels = 8, factor = 2;
+    constexpr int numJobs = numChannels * numBands;
+
+    struct DistortionJobs : WorkerPool::Batch
+    {
+        void runJob(int index) override
+        {
+            auto& buffer = buffers[(size_t) index];
+            buffer.makeCopyOf(input, true);
+            juce::dsp::AudioBlock<float> block(buffer);
+            distortions[(size_t) index].process(juce::dsp::ProcessContextReplacing<float>(block), true);
+        }
+
+        juce::AudioBuffer<float> input;
+        std::array<Distortion<float>, numJobs> distortions;
+        std::array<juce::AudioBuffer<float>, numJobs> buffers;
+    };
+
+    for (int numWorkers = 0; numWorkers <= juce::jmin(maxWorkers, juce::SystemStats::getNumCpus() - 1); ++numWorkers)
+    {
+        WorkerPool pool;
+        pool.prepare(numWorkers);
+
+        for (auto blockSize : blockSizes)
+        {
+            const auto name = "parallel/" + juce::String(numWorkers) + "/" + juce::String(blockSize);
+            if (! runner.shouldRun(name))
+                continue;
+
+            const auto bandSamples = blockSize * factor;
+            DistortionJobs jobs;
+            jobs.input.setSize(1, bandSamples);
+            fillTestSignal(jobs.input, stageOversampledRate);
+
+            for (size_t job = 0; job < (size_t) numJobs; ++job)
+            {
+                jobs.distortions[job].prepare({ stageOversampledRate, (juce::uint32) bandSamples, 1 });
+                jobs.distortions[job].setDrive(10.0f);
+                jobs.buffers[job].setSize(1, bandSamples);
+            }
+
+            juce::DynamicObject::Ptr details(new juce::DynamicObject());
+            details->setProperty("group", "parallel");
+            details->setProperty("workers", numWorkers);
+            details->setProperty("block_size", blockSize);
+
+            runner.run(name, details, blockSize, stageHostRate, [&]
+            {
+                pool.run(jobs, numJobs);
+            });
+        }
+    }
+}
+
+void benchmarkFFTDataGenerator(BenchmarkRunner& runner)
+{
+    for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 })
+    {
+        const auto fftSize = 1 << order;
+        const auto name = "stage/fft/" + juce::String(fftSize);
+        if (! runner.shouldRun(name))
+            continue;
+
+        FFTDataGenerator<std::vector<float>> generator;
+        generator.changeOrder(order);
+
+        juce::AudioBuffer<float> input(1, fftSize);
+        fillTestSignal(input, stageHostRate);
+        std::vector<float> fftData;
+
+        auto details = makeStageDetails<float>("FFTDataGenerator");
+        details->setProperty("fft_size", fftSize);
+
+        // The editor drains the fifo as it goes, so this does too
+        runner.run(name, details, fftSize, stageHostRate, [&]
+        {
+            generator.produceFFTDataForRendering(input, -48.0f);
+            generator.getFFTData(fftData);
+        });
+    }
+}
+
+//==============================================================================
+// Golden renders: every case is a parameter state, rendered from fixed test signals
+// at 48 kHz and compared with a reference written by an earlier --record-golden run
+constexpr double goldenSampleRate = 48000.0;
+constexpr int goldenBlockSize = 512;
+// Odd and tiny sizes catch anything that resets at block boundaries
+constexpr int otherGoldenBlockSizes[] { 1, 37, 64, 2048 };
+// Automated cases must also come out the same from the smallest blocks hosts send and
+// from large ones. Automation steps every goldenAutomationInterval samples, which
+// both sizes divide, so neither render ever has to split a block for it.
+constexpr int goldenAutomationInterval = 1024;
+constexpr int smallAutomatedBlockSize = 16, largeAutomatedBlockSize = 1024;
+
+struct GoldenCase
+{
+    juce::String name;
+    std::function<void(juce::AudioProcessorValueTreeState&)> configure;
+
+    // Called every goldenAutomationInterval samples through the render with the time in
+    // seconds, to move parameters the way host automation would. Empty for static cases.
+    std::function<void(juce::AudioProcessorValueTreeState&, double)> automate;
+};
+
+void setAllBands(juce::AudioProcessorValueTreeState& apvts, DistortionType type, float drive)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto prefix = getBandParameterPrefix(band);
+        setParameter(apvts, prefix + "Type", (float) type);
+        setParameter(apvts, prefix + "Drive", drive);
+    }
+}
+
+std::vector<GoldenCase> getGoldenCases()
+{
+    std::vector<GoldenCase> cases;
+
+    // Defaults, which take the bypass path, and the EQ on its own
+    cases.push_back({ "clean", [](auto&) {} });
+    cases.push_back({ "eq", [](auto& apvts)
+    {
+        setParameter(apvts, "Low-Cut Frequency", 40.0f);
+        setParameter(apvts, "Low-Cut Slope", 3.0f);
+        setParameter(apvts, "High-Cut Frequency", 16000.0f);
+        setParameter(apvts, "High-Cut Slope", 3.0f);
+        setParameter(apvts, "Peak Gain", 6.0f);
+    }});
+
+    // Every distortion type on every band
+    for (int type = 0; type < distortionTypeNames.size(); ++type)
+    {
+        cases.push_back({ distortionTypeNames[type], [type](auto& apvts)
+        {
+            setAllBands(apvts, (DistortionType) type, 20.0f);
+        }});
+    }
+
+    // The rest of the oversampled path
+    cases.push_back({ "SoftClipping/4x-FIR", [](auto& apvts)
+    {
+        setAllBands(apvts, DistortionType::SoftClipping, 20.0f);
+        setParameter(apvts, "OversamplingFactor", 2.0f);
+        setParameter(apvts, "OversamplingFilter", 1.0f);
+    }});
+    cases.push_back({ "SoftClipping/linear-phase", [](auto& apvts)
+    {
+        setAllBands(apvts, DistortionType::SoftClipping, 20.0f);
+        setParameter(apvts, "CrossoverMode", 1.0f);
+    }});
+    cases.push_back({ "SoftClipping/no-compensation", [](auto& apvts)
+    {
+        setAllBands(apvts, DistortionType::SoftClipping, 20.0f);
+        setParameter(apvts, "LevelCompensation", 0.0f);
+    }});
+
+    for (int quality = 0; quality < shaperQualityNames.size(); ++quality)
+    {
+        cases.push_back({ "ArcTan/" + shaperQualityNames[quality], [quality](auto& apvts)
+        {
+            setAllBands(apvts, DistortionType::ArcTan, 35.0f);
+            setParameter(apvts, "ShaperQuality", (float) quality);
+        }});
+    }
+
+    // Every crossover gliding three octaves up and back down again over the one second
+    // render while every band distorts, so the bands' edges move under the shapers
+    const auto sweepCrossovers = [](juce::AudioProcessorValueTreeState& apvts, double seconds)
+    {
+        const auto octaves = 3.0 * (1.0 - std::abs(2.0 * seconds - 1.0));
+        for (int i = 0; i < numCrossovers; ++i)
+            setParameter(apvts, getCrossoverParameterID(i), (float) juce::jlimit(20.0, 20000.0, 80.0 * std::pow(4.0, i) * std::exp2(octaves)));
+    };
+
+    cases.push_back({ "crossover-sweep", [sweepCrossovers](auto& apvts)
+    {
+        setAllBands(apvts, DistortionType::SoftClipping, 20.0f);
+        sweepCrossovers(apvts, 0.0);
+    }, sweepCrossovers });
+
+    // Different settings per band, with one band inactive
+    cases.push_back({ "mixed", [](auto& apvts)
+    {
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto prefix = getBandParameterPrefix(band);
+            setParameter(apvts, prefix + "Type", (float) (band % 2 == 0 ? DistortionType::HardClipping : DistortionType::BitCrusher));
+            setParameter(apvts, prefix + "Drive", band == 1 ? 0.0f : 10.0f + 10.0f * band);
+            setParameter(apvts, prefix + "PostGain", -6.0f);
+            setParameter(apvts, prefix + "Mix", 100.0f);
+        }
+    }});
+
+    return cases;
+}
+
+// A one second sweep from 20 Hz to 20 kHz at -6 dBFS, the same on both channels
+void fillSweep(juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto duration = numSamples / sampleRate;
+    const auto rate = std::log(1000.0);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto t = i / sampleRate;
+        const auto phase = juce::MathConstants<double>::twoPi * 20.0 * duration / rate * (std::exp(rate * t / duration) - 1.0);
+        const auto sample = 0.5f * (float) std::sin(phase);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            buffer.setSample(channel, i, sample);
+    }
+}
+
+// Returns nullptr if the processor won't take a bus of numChannels
+std::unique_ptr<_3BandMultiEffectorAudioProcessor> makeGoldenProcessor(const GoldenCase& goldenCase, int numChannels, int blockSize)
+{
+    auto processor = std::make_unique<_3BandMultiEffectorAudioProcessor>();
+
+    // The same layout the batch renderer gives a file with this many channels
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if (! processor->setBusesLayout(layout))
+        return nullptr;
+
+    processor->setNonRealtime(true);
+    goldenCase.configure(processor->apvts);
+    processor->setRateAndBufferSizeDetails(goldenSampleRate, blockSize);
+    processor->prepareToPlay(goldenSampleRate, blockSize);
+    return processor;
+}
+
+// Renders the whole input through a fresh processor, blockSize samples at a time,
+// with a shorter last block like a host would send. The processor gets a bus of as many
+// channels as the input has, and the render is empty if it won't take one.
+// Automation is applied on its own sample whatever the block size: a block that spans
+// an automation point is split there, as hosts with sample-accurate automation do.
+juce::AudioBuffer<float> renderGolden(const GoldenCase& goldenCase, const juce::AudioBuffer<float>& input, int blockSize)
+{
+    auto processor = makeGoldenProcessor(goldenCase, input.getNumChannels(), blockSize);
+    if (processor == nullptr)
+        return {};
+
+    juce::AudioBuffer<float> output;
+    output.makeCopyOf(input);
+    juce::MidiBuffer midi;
+
+    for (int start = 0; start < output.getNumSamples(); start += blockSize)
+    {
+        const auto end = juce::jmin(start + blockSize, output.getNumSamples());
+
+        for (auto position = start; position < end;)
+        {
+            auto next = end;
+
+            if (goldenCase.automate)
+            {
+                if (position % goldenAutomationInterval == 0)
+                    goldenCase.automate(processor->apvts, position / goldenSampleRate);
+
+                next = juce::jmin(end, (position / goldenAutomationInterval + 1) * goldenAutomationInterval);
+            }
+
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), output.getNumChannels(), position, next - position);
+            processor->processBlock(block, midi);
+            position = next;
+        }
+    }
+
+    processor->releaseResources();
+    return output;
+}
+
+bool hasNaNs(const juce::AudioBuffer<float>& buffer)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            if (std::isnan(buffer.getSample(channel, i)))
+                return true;
+
+    return false;
+}
+
+// The peak of the difference between two renders in dBFS. Renders of different sizes,
+// or with NaNs in them, don't null at all.
+float getNullResidualDecibels(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+{
+    if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+        return 0.0f;
+
+    // NaNs never compare greater, so they'd otherwise pass as a perfect null
+    if (hasNaNs(a) || hasNaNs(b))
+        return 0.0f;
+
+    auto peak = 0.0f;
+    for (int channel = 0; channel < a.getNumChannels(); ++channel)
+    {
+        const auto* aData = a.getReadPointer(channel);
+        const auto* bData = b.getReadPointer(channel);
+
+        for (int i = 0; i < a.getNumSamples(); ++i)
+            peak = juce::jmax(peak, std::abs(aData[i] - bData[i]));
+    }
+
+    return juce::Decibels::gainToDecibels(peak, -400.0f);
+}
+
+// References are 32 bit float WAVs, so they hold the render exactly
+bool writeReference(const juce::File& file, const juce::AudioBuffer<float>& buffer)
+{
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (! stream->openedOk())
+        return false;
+
+    juce::WavAudioFormat format;
+    std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), goldenSampleRate,
+                                                                           (unsigned int) buffer.getNumChannels(), 32, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // the writer owns it now
+    return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+bool readReference(const juce::File& file, juce::AudioBuffer<float>& buffer)
+{
+    juce::WavAudioFormat format;
+    std::unique_ptr<juce::AudioFormatReader> reader(format.createReaderFor(file.createInputStream().release(), true));
+    if (reader == nullptr)
+        return false;
+
+    buffer.setSize((int) reader->numChannels, (int) reader->lengthInSamples);
+    return reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+}
+
+class GoldenChecker
+{
+public:
+    GoldenChecker(const Options& optionsToUse, BenchmarkRunner& runnerToUse, juce::StringArray& failuresToFill)
+        : options(optionsToUse), runner(runnerToUse), failures(failuresToFill) {}
+
+    void run()
+    {
+        if (! options.goldenFolder.createDirectory())
+        {
+            failures.add("can't create " + options.goldenFolder.getFullPathName());
+            return;
+        }
+
+        const auto numSamples = juce::roundToInt(goldenSampleRate);
+        juce::AudioBuffer<float> sineAndNoise(2, numSamples), sweep(2, numSamples);
+        fillTestSignal(sineAndNoise, goldenSampleRate);
+        fillSweep(sweep, goldenSampleRate);
+
+        // Mono and 5.1, so the per-channel state and band jobs are covered beyond stereo
+        juce::AudioBuffer<float> mono(1, numSamples), sixChannels(6, numSamples);
+        fillTestSignal(mono, goldenSampleRate);
+        fillTestSignal(sixChannels, goldenSampleRate);
+
+       #if MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+        checkAllocationCheck();
+        const auto violationsBefore = ScopedAudioThreadAllocationCheck::getNumViolations();
+       #endif
+
+        for (const auto& goldenCase : getGoldenCases())
+        {
+            check(goldenCase, "sine-noise", sineAndNoise);
+            check(goldenCase, "sweep", sweep);
+            check(goldenCase, "mono", mono);
+            check(goldenCase, "6-channel", sixChannels);
+        }
+
+       #if MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+        // Every render above went through processBlock, which has to have stayed allocation-free
+        if (const auto violations = ScopedAudioThreadAllocationCheck::getNumViolations() - violationsBefore; violations > 0)
+            fail("golden/allocation-check", "processBlock allocated " + juce::String(violations) + " times during the renders");
+       #endif
+
+        checkFastMath<float>();
+        checkFastMath<double>();
+        checkBitCrusherBands();
+    }
+
+private:
+   #if MULTIEFFECTOR_ASSERT_NO_AUDIO_ALLOCATIONS
+    // Opens the same check processBlock does around the allocations a careless processBlock
+    // might make, and expects each one to be caught: a std::vector growing, which goes
+    // through operator new, and an AudioBuffer::setSize, which juce::HeapBlock makes with
+    // malloc, so it's only seen where MULTIEFFECTOR_WRAP_MALLOC is set. Both are meant to
+    // hit the jassert, so expect it to be logged twice.
+    void checkAllocationCheck()
+    {
+        const juce::String name = "golden/allocation-check";
+        if (! runner.shouldRun(name))
+            return;
+
+        std::vector<float> vector;
+        juce::AudioBuffer<float> buffer;
+        const auto before = ScopedAudioThreadAllocationCheck::getNumViolations();
+        int vectorViolations = 0;
+
+        {
+            ScopedAudioThreadAllocationCheck allocationCheck;
+            vector.resize(goldenBlockSize);
+            vectorViolations = ScopedAudioThreadAllocationCheck::getNumViolations() - before;
+            buffer.setSize(2, goldenBlockSize);
+        }
+
+        const auto bufferViolations = ScopedAudioThreadAllocationCheck::getNumViolations() - before - vectorViolations;
+
+        if (vectorViolations == 0)
+            fail(name, "a std::vector::resize inside the check wasn't caught");
+
+        if (MULTIEFFECTOR_WRAP_MALLOC && bufferViolations == 0)
+            fail(name, "an AudioBuffer::setSize inside the check wasn't caught");
+    }
+   #endif
+
+    // Three bit crushers at different depths, processed block by block in turn on one
+    // thread the way the bands are, each fed a ramp that its drive turns into -0.5 to
+    // 0.5. Every output has to be a whole number of 2^-bits steps, with single steps
+    // between neighbouring samples, so no band's depth can leak into another's.
+    void checkBitCrusherBands()
+    {
+        const juce::String name = "golden/bitcrusher/bands";
+        if (! runner.shouldRun(name))
+            return;
+
+        constexpr float bitDepths[] { 4.0f, 8.0f, 12.0f };
+        constexpr auto numCrushers = (size_t) std::size(bitDepths);
+        const auto numSamples = juce::roundToInt(goldenSampleRate);
+
+        std::array<Distortion<float>, numCrushers> crushers;
+        std::array<juce::AudioBuffer<float>, numCrushers> buffers;
+
+        for (size_t i = 0; i < numCrushers; ++i)
+        {
+            crushers[i].prepare({ goldenSampleRate, (juce::uint32) goldenBlockSize, 1 });
+            crushers[i].setType(DistortionType::BitCrusher);
+            crushers[i].setDrive(bitDepths[i]);
+            crushers[i].reduceBitDepth(bitDepths[i]);
+            crushers[i].setPostGain(0.0f);
+            crushers[i].setMix(1.0f);
+
+            buffers[i].setSize(1, numSamples);
+            for (int sample = 0; sample < numSamples; ++sample)
+                buffers[i].setSample(0, sample, ((float) sample / (float) (numSamples - 1) - 0.5f) / bitDepths[i]);
+        }
+
+        for (int start = 0; start < numSamples; start += goldenBlockSize)
+        {
+            const auto blockSize = (size_t) juce::jmin(goldenBlockSize, numSamples - start);
+
+            for (size_t i = 0; i < numCrushers; ++i)
+            {
+                auto block = juce::dsp::AudioBlock<float>(buffers[i]).getSubBlock((size_t) start, blockSize);
+                crushers[i].process(juce::dsp::ProcessContextReplacing<float>(block), false);
+            }
+        }
+
+        for (size_t i = 0; i < numCrushers; ++i)
+        {
+            const auto levels = std::exp2(bitDepths[i]);
+            const auto* output = buffers[i].getReadPointer(0);
+            const auto bandName = juce::String(bitDepths[i], 0) + " bits: ";
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                const auto steps = output[sample] * levels;
+                const auto stepsFromLast = sample > 0 ? std::abs(steps - output[sample - 1] * levels) : 0.0;
+
+                if (steps != std::round(steps) || stepsFromLast > 1.0)
+                {
+                    fail(name, bandName + "sample " + juce::String(sample) + " is " + juce::String(output[sample], 10)
+                               + ", which isn't on the 2^-" + juce::String(bitDepths[i], 0) + " grid one step from the last");
+                    break;
+                }
+            }
+
+            // A ramp across the whole range has to take every step on the way
+            const auto numSteps = output[numSamples - 1] * levels - output[0] * levels;
+            if (numSteps != levels)
+                fail(name, bandName + "the ramp took " + juce::String(numSteps) + " steps instead of " + juce::String(levels));
+        }
+    }
+
+    // The Fast curves against the standard library, one sample at a time and a vector
+    // at a time, over every argument a drive of up to 50 gives on a signal peaking at
+    // +24 dBFS. tanh, atan and sin have to stay within the error FastMath.h documents,
+    // and the bit crusher's rounding has to be exact at every bit depth.
+    template<typename FloatType>
+    void checkFastMath()
+    {
+        const auto name = "fastmath" + getPrecisionSuffix<FloatType>();
+        if (! runner.shouldRun(name))
+            return;
+
+        constexpr double maxArgument = 800.0;
+        constexpr int maxBitDepth = 50;
+        constexpr size_t numArguments = 1 << 20;
+
+        std::vector<FloatType> arguments(numArguments), results(numArguments);
+        for (size_t i = 0; i < numArguments; ++i)
+            arguments[i] = static_cast<FloatType>(maxArgument * (2.0 * (double) i / (double) (numArguments - 1) - 1.0));
+
+       #if MULTIEFFECTOR_FASTMATH_VECTORS
+        const bool forms[] { false, true };
+       #else
+        const bool forms[] { false };
+       #endif
+
+        for (const bool vectors : forms)
+        {
+            const juce::String form = vectors ? "vector" : "scalar";
+
+            // Works for both forms, as every FastMath function takes a float or a Vector
+            auto evaluate = [&](auto function)
+            {
+                size_t i = 0;
+               #if MULTIEFFECTOR_FASTMATH_VECTORS
+                constexpr auto numLanes = FastMath::numLanes<FloatType>;
+                if (vectors)
+                    for (; i + numLanes <= numArguments; i += numLanes)
+                        FastMath::store(results.data() + i, function(FastMath::load(arguments.data() + i)));
+               #endif
+                for (; i < numArguments; ++i)
+                    results[i] = function(arguments[i]);
+            };
+
+            auto checkError = [&](const juce::String& function, double maxError, double (*exact)(double))
+            {
+                double worst = 0.0;
+                for (size_t i = 0; i < numArguments; ++i)
+                    worst = juce::jmax(worst, std::abs((double) results[i] - exact((double) arguments[i])));
+
+                if (! (worst <= maxError))
+                    fail(name, form + " " + function + " is out by " + juce::String(worst, 10) + ", more than " + juce::String(maxError, 10));
+            };
+
+            evaluate([](auto x) { return FastMath::tanh(x); });
+            checkError("tanh", 3.7e-7, [](double x) { return std::tanh(x); });
+            evaluate([](auto x) { return FastMath::atan(x); });
+            checkError("atan", 1.9e-6, [](double x) { return std::atan(x); });
+            evaluate([](auto x) { return FastMath::sin(x); });
+            checkError("sin", 2.0e-7, [](double x) { return std::sin(x); });
+
+            for (int bitDepth = 0; bitDepth <= maxBitDepth; ++bitDepth)
+            {
+                const auto levels = static_cast<FloatType>(std::exp2(bitDepth));
+                evaluate([levels](auto x) { return FastMath::roundHalfAwayFromZero(x * levels); });
+
+                for (size_t i = 0; i < numArguments; ++i)
+                {
+                    if (results[i] != std::round(arguments[i] * levels))
+                    {
+                        fail(name, form + " roundHalfAwayFromZero is wrong at " + juce::String(arguments[i] * levels, 10)
+                                   + " (" + juce::String(bitDepth) + " bits)");
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void check(const GoldenCase& goldenCase, const juce::String& signalName, const juce::AudioBuffer<float>& input)
+    {
+        const auto name = "golden/" + signalName + "/" + goldenCase.name;
+        if (! runner.shouldRun(name))
+            return;
+
+        const auto reference = renderGolden(goldenCase, input, goldenBlockSize);
+        if (reference.getNumChannels() == 0)
+        {
+            fail(name, "the processor doesn't support " + juce::String(input.getNumChannels()) + " channels");
+            return;
+        }
+
+        const auto file = options.goldenFolder.getChildFile((signalName + "_" + goldenCase.name).replaceCharacter('/', '_') + ".wav");
+
+        if (hasNaNs(reference))
+            fail(name, "the render has NaNs in it");
+        else if (options.recordGolden && ! writeReference(file, reference))
+            fail(name, "can't write " + file.getFullPathName());
+        else if (! options.recordGolden)
+            compareWithReference(name, file, reference);
+
+        for (auto blockSize : otherGoldenBlockSizes)
+        {
+            const auto residual = getNullResidualDecibels(reference, renderGolden(goldenCase, input, blockSize));
+            if (residual > options.nullThresholdDecibels)
+                fail(name, "blocks of " + juce::String(blockSize) + " differ from blocks of " + juce::String(goldenBlockSize)
+                           + " by " + juce::String(residual, 1) + " dBFS");
+        }
+
+        if (goldenCase.automate)
+        {
+            const auto residual = getNullResidualDecibels(renderGolden(goldenCase, input, smallAutomatedBlockSize),
+                                                          renderGolden(goldenCase, input, largeAutomatedBlockSize));
+            if (residual > options.nullThresholdDecibels)
+                fail(name, "with automation, blocks of " + juce::String(smallAutomatedBlockSize) + " differ from blocks of "
+                           + juce::String(largeAutomatedBlockSize) + " by " + juce::String(residual, 1) + " dBFS");
+        }
+
+        // Timed like the processor cases, so --baseline covers the golden states too
+        auto processor = makeGoldenProcessor(goldenCase, input.getNumChannels(), goldenBlockSize);
+        juce::AudioBuffer<float> buffer(input.getNumChannels(), goldenBlockSize);
+        juce::MidiBuffer midi;
+        int position = 0;
+
+        juce::DynamicObject::Ptr details(new juce::DynamicObject());
+        details->setProperty("group", "golden");
+        details->setProperty("signal", signalName);
+        details->setProperty("case", goldenCase.name);
+
+        runner.run(name, details, goldenBlockSize, goldenSampleRate, [&]
+        {
+            if (position + goldenBlockSize > input.getNumSamples())
+                position = 0;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.copyFrom(channel, 0, input, channel, position, goldenBlockSize);
+
+            position += goldenBlockSize;
+            processor->processBlock(buffer, midi);
+        });
+    }
+
+    void compareWithReference(const juce::String& name, const juce::File& file, const juce::AudioBuffer<float>& render)
+    {
+        juce::AudioBuffer<float> reference;
+        if (! readReference(file, reference))
+        {
+            fail(name, "no reference at " + file.getFullPathName() + ", record one with --record-golden");
+            return;
+        }
+
+        const auto residual = getNullResidualDecibels(reference, render);
+        if (residual > options.nullThresholdDecibels)
+            fail(name, "differs from the reference by " + juce::String(residual, 1) + " dBFS");
+    }
+
+    void fail(const juce::String& name, const juce::String& reason)
+    {
+        failures.add(name + ": " + reason);
+        std::cout << "FAILED " << name << ": " << reason << std::endl;
+    }
+
+    const Options& options;
+    BenchmarkRunner& runner;
+    juce::StringArray& failures;
+};
+
+// Adds each result's slowdown against the result of the same name in the baseline,
+// and fails the ones that slowed down by more than the allowed percentage. Cases
+// that aren't in the baseline are new, and pass.
+void compareWithBaseline(const juce::Array<juce::var>& results, const juce::var& baseline,
+                         double maxSlowdownPercent, juce::StringArray& failures)
+{
+    std::map<juce::String, double> baselineTimes;
+    if (const auto* baselineResults = baseline["results"].getArray())
+        for (const auto& result : *baselineResults)
+            baselineTimes[result["name"].toString()] = (double) result["ns_per_sample"];
+
+    for (const auto& result : results)
+    {
+        const auto name = result["name"].toString();
+        const auto found = baselineTimes.find(name);
+        if (found == baselineTimes.end() || found->second <= 0.0)
+            continue;
+
+        const auto slowdownPercent = ((double) result["ns_per_sample"] / found->second - 1.0) * 100.0;
+        result.getDynamicObject()->setProperty("baseline_ns_per_sample", found->second);
+        result.getDynamicObject()->setProperty("slowdown_percent", slowdownPercent);
+
+        if (slowdownPercent > maxSlowdownPercent)
+        {
+            const auto reason = name + ": " + juce::String(slowdownPercent, 1) + "% slower than the baseline";
+            failures.add(reason);
+            std::cout << "FAILED " << reason << std::endl;
+        }
+    }
+}
+
+juce::var getMachineDetails()
+{
+    juce::DynamicObject::Ptr machine(new juce::DynamicObject());
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+    machine->setProperty("num_bands", numBands);
+   #if JUCE_DEBUG
+    machine->setProperty("build", "Debug");
+   #else
+    machine->setProperty("build", "Release");
+   #endif
+    return machine.get();
+}
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor's parameter tree runs a timer, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+    for (int i = 1; i < argc; ++i)
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+
+    Options options;
+    if (! parseArguments(arguments, options))
+    {
+        std::cout << "Usage: Benchmarks [--output file] [--seconds S] [--repetitions N] [--filter text]" << std::endl
+                  << "                  [--golden dir | --record-golden dir] [--null-threshold dB]" << std::endl
+                  << "                  [--baseline file] [--max-slowdown percent]" << std::endl;
+        return 1;
+    }
+
+    juce::var baseline;
+    if (options.baselineFile != juce::File())
+    {
+        baseline = juce::JSON::parse(options.baselineFile);
+        if (! baseline.isObject())
+        {
+            std::cout << "Can't read the baseline from " << options.baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    juce::StringArray failures;
+    BenchmarkRunner runner(options);
+    benchmarkProcessor(runner);
+    benchmarkPrecision<float>(runner, juce::AudioProcessor::singlePrecision, "float");
+    benchmarkPrecision<double>(runner, juce::AudioProcessor::doublePrecision, "double");
+    benchmarkControlRate(runner);
+    benchmarkDistortion<float>(runner);
+    benchmarkDistortion<double>(runner);
+    benchmarkCrossover<float>(runner);
+    benchmarkCrossover<double>(runner);
+    benchmarkMonoChain<float>(runner);
+    benchmarkMonoChain<double>(runner);
+    benchmarkMultichannelEQ<float>(runner);
+    benchmarkMultichannelEQ<double>(runner);
+    benchmarkOversampling<float>(runner);
+    benchmarkOversampling<double>(runner);
+    benchmarkWorkerPool(runner);
+    benchmarkFFTDataGenerator(runner);
+
+    if (options.goldenFolder != juce::File())
+        GoldenChecker(options, runner, failures).run();
+
+    if (baseline.isObject())
+        compareWithBaseline(runner.getResults(), baseline, options.maxSlowdownPercent, failures);
+
+    juce::DynamicObject::Ptr settings(new juce::DynamicObject());
+    settings->setProperty("seconds", options.seconds);
+    settings->setProperty("repetitions", options.repetitions);
+    settings->setProperty("filter", options.filter);
+    settings->setProperty("null_threshold_db", options.nullThresholdDecibels);
+    settings->setProperty("max_slowdown_percent", options.maxSlowdownPercent);
+
+    juce::DynamicObject::Ptr root(new juce::DynamicObject());
+    root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("machine", getMachineDetails());
+    root->setProperty("settings", settings.get());
+    root->setProperty("results", runner.getResults());
+    root->setProperty("failures", failures);
+
+    if (! options.outputFile.replaceWithText(juce::JSON::toString(juce::var(root.get()))))
+    {
+        std::cout << "Can't write " << options.outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << std::endl << "Wrote " << runner.getResults().size() << " results to " << options.outputFile.getFullPathName() << std::endl;
+
+    if (options.recordGolden && failures.isEmpty())
+        std::cout << "Recorded the golden references in " << options.goldenFolder.getFullPathName() << std::endl;
+
+    if (! failures.isEmpty())
+    {
+        std::cout << std::endl << failures.size() << " checks failed:" << std::endl;
+        for (const auto& failure : failures)
+            std::cout << "  " << failure << std::endl;
+        return 1;
+    }
+
+    return 0;
+}